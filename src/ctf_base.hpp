@@ -87,7 +87,7 @@ class Symbol {
   Symbol::eof() is a terminal symbol as well.
   */
   constexpr bool terminal() const noexcept {
-    return _storage & (static_cast<std::size_t>(0x1) << type_shift());
+    return _storage & (static_cast<id_type>(0x1) << type_shift());
   }
   /**
   \brief Returns true if the symbol is a nonterminal.
@@ -141,18 +141,19 @@ class Symbol {
 
  protected:
   constexpr Symbol(Type type, std::size_t id = 0) noexcept
-    : _storage((static_cast<std::size_t>(type) << type_shift()) | (id & id_mask())) {}
+    : _storage((static_cast<id_type>(type) << type_shift()) |
+               (static_cast<id_type>(id) & id_mask())) {}
 
   /**
-  \brief Id of this Symbol.
+  \brief Type and id of this Symbol.
   */
-  std::size_t _storage;
+  id_type _storage;
 
-  static constexpr std::size_t id_mask() noexcept {
-    return (std::numeric_limits<std::size_t>::max() << 2) >> 2;
+  static constexpr id_type id_mask() noexcept {
+    return static_cast<id_type>(std::numeric_limits<id_type>::max() << 2) >> 2;
   }
-  static constexpr std::size_t type_mask() noexcept { return ~id_mask(); }
-  static constexpr std::size_t type_shift() noexcept { return sizeof(std::size_t) * 8 - 2; }
+  static constexpr id_type type_mask() noexcept { return static_cast<id_type>(~id_mask()); }
+  static constexpr std::size_t type_shift() noexcept { return sizeof(id_type) * 8 - 2; }
 };
 
 /**
@@ -287,6 +288,10 @@ struct Location {
 
 /**
 \brief Attribute class. Holds values of any type.
+
+An attribute may be deferred: it holds the raw lexeme and a conversion function, and the lexeme
+is only converted when the value is first accessed. Accessing a deferred attribute modifies it, so
+a single Attribute object must not be accessed concurrently.
 */
 class Attribute {
  public:
@@ -351,7 +356,25 @@ class Attribute {
   ~Attribute() = default;
 
   /**
-  \brief Retreives a value from storage.
+  \brief Constructs an Attribute that converts a lexeme to its value when it is first accessed.
+
+  \tparam T The type of the converted value.
+
+  \param[in] lexeme The raw lexeme.
+  \param[in] convert The conversion function. Captureless lambdas may be passed with unary +.
+
+  \returns A deferred Attribute.
+  */
+  template <typename T>
+  static Attribute deferred(string lexeme, T (*convert)(const string&)) {
+    Attribute result;
+    result._storage.emplace<Deferred>(Deferred{
+      std::move(lexeme), reinterpret_cast<void (*)()>(convert), &Attribute::materialize_as<T>});
+    return result;
+  }
+
+  /**
+  \brief Retreives a value from storage. Converts deferred attributes.
 
   \tparam T The type of the retreived object.
 
@@ -359,6 +382,7 @@ class Attribute {
   */
   template <typename T>
   T get() const {
+    materialize();
     return std::any_cast<T>(_storage);
   }
   /**
@@ -418,9 +442,17 @@ class Attribute {
   bool empty() const noexcept { return !_storage.has_value(); }
 
   /**
-  \brief Get the type info of the stored object.
+  \brief Returns true if the stored value is deferred and has not been converted yet.
   */
-  const std::type_info& type() const noexcept { return _storage.type(); }
+  bool is_deferred() const noexcept { return _storage.type() == typeid(Deferred); }
+
+  /**
+  \brief Get the type info of the stored object. Converts deferred attributes.
+  */
+  const std::type_info& type() const {
+    materialize();
+    return _storage.type();
+  }
 
   /**
   \name Comparison operators
@@ -445,10 +477,41 @@ class Attribute {
   ///@}
 
  private:
+  /**
+  \brief A lexeme with its conversion function.
+  */
+  struct Deferred {
+    string lexeme;
+    /**
+    \brief The type-erased conversion function.
+    */
+    void (*convert)();
+    /**
+    \brief Calls the conversion function with the original type.
+    */
+    std::any (*materialize)(const Deferred&);
+  };
+
   /**
   \brief Stores any value.
   */
-  std::any _storage;
+  mutable std::any _storage;
+
+  template <typename T>
+  static std::any materialize_as(const Deferred& lazy) {
+    auto convert = reinterpret_cast<T (*)(const string&)>(lazy.convert);
+    return std::any(convert(lazy.lexeme));
+  }
+
+  /**
+  \brief Replaces a deferred value with its converted value.
+  */
+  void materialize() const {
+    if (auto lazy = std::any_cast<Deferred>(&_storage)) {
+      std::any value = lazy->materialize(*lazy);
+      _storage = std::move(value);
+    }
+  }
 };
 
 /**
@@ -699,8 +762,8 @@ inline void swap(ctf::Attribute& lhs, ctf::Attribute& rhs) noexcept { lhs.swap(r
 template <>
 struct hash<ctf::Symbol> {
   std::size_t operator()(const ctf::Symbol& s) const noexcept {
-    // reinterpret as a std::size_t
-    return std::hash<std::size_t>{}(reinterpret_cast<const std::size_t&>(s));
+    // reinterpret as the id storage type
+    return std::hash<ctf::id_type>{}(reinterpret_cast<const ctf::id_type&>(s));
   }
 };
 }  // namespace std
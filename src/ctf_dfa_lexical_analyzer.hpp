@@ -0,0 +1,754 @@
+/**
+\file ctf_dfa_lexical_analyzer.hpp
+\brief Defines class LexerDFA, a table-driven lexer automaton that can split large inputs between
+threads and can be compiled from regular expressions, and class DFALexicalAnalyzer.
+\author Radek Vít
+*/
+#ifndef CTF_DFA_LEXICAL_ANALYZER_H
+#define CTF_DFA_LEXICAL_ANALYZER_H
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+#include "ctf_lexical_analyzer.hpp"
+
+namespace ctf {
+
+/**
+\brief The kind of a matched lexeme.
+*/
+enum class LexemeKind : unsigned char {
+  /**
+  \brief A single character that does not start any lexeme.
+  */
+  ERROR,
+  /**
+  \brief A lexeme returned as a token.
+  */
+  TOKEN,
+  /**
+  \brief A discarded lexeme, such as whitespace or a comment.
+  */
+  SKIP,
+};
+
+/**
+\brief A lexeme matched by LexerDFA. Stores offsets into the input.
+*/
+struct Lexeme {
+  std::size_t begin;
+  std::size_t end;
+  /**
+  \brief The terminal of a TOKEN lexeme. EOF for other kinds.
+  */
+  Symbol symbol;
+  LexemeKind kind;
+
+  bool operator==(const Lexeme& other) const noexcept {
+    return begin == other.begin && end == other.end && symbol == other.symbol &&
+           kind == other.kind;
+  }
+  bool operator!=(const Lexeme& other) const noexcept { return !(*this == other); }
+};
+
+/**
+\brief A lexeme pattern compiled by LexerDFA::compile().
+
+Patterns are regular expressions over bytes. They consist of characters, '.' (any character except
+a newline), classes such as [a-z_] and [^"\n], groups, '|', '*', '+' and '?'. A backslash escapes
+any operator; \n, \t, \r, \d, \s and \w have their usual meaning, also inside classes.
+*/
+struct TokenPattern {
+  string pattern;
+  /**
+  \brief The terminal of TOKEN patterns.
+  */
+  Symbol terminal = Symbol::eof();
+  /**
+  \brief TOKEN or SKIP.
+  */
+  LexemeKind kind = LexemeKind::TOKEN;
+};
+
+/**
+\brief A deterministic finite automaton over bytes that splits input into lexemes by the longest
+match rule. State 0 is the start state.
+
+Lexing is restartable at every lexeme boundary: the lexemes following a boundary only depend on
+the input after it. lex() uses this to split large inputs into chunks lexed concurrently.
+*/
+class LexerDFA {
+ public:
+  /**
+  \brief The start state.
+  */
+  static constexpr id_type start = 0;
+  /**
+  \brief The target of missing transitions.
+  */
+  static constexpr id_type dead = std::numeric_limits<id_type>::max();
+
+  /**
+  \brief Constructs the automaton with the start state only.
+  */
+  LexerDFA() { add_state(); }
+
+  /**
+  \brief Compiles lexeme patterns to an automaton.
+
+  \param[in] patterns The patterns. When several patterns match the longest lexeme, the first one
+  is selected.
+
+  \returns The automaton matching the patterns.
+  */
+  static LexerDFA compile(const vector<TokenPattern>& patterns);
+
+  /**
+  \brief Adds a non-accepting state without transitions.
+
+  \returns The new state.
+  */
+  id_type add_state() {
+    _transitions.resize(_transitions.size() + alphabet, dead);
+    _accepting.push_back({Symbol::eof(), LexemeKind::ERROR});
+    return static_cast<id_type>(_accepting.size() - 1);
+  }
+
+  /**
+  \brief Adds a transition on a single character.
+
+  \param[in] from The source state.
+  \param[in] c The character.
+  \param[in] to The target state.
+  */
+  void add_transition(id_type from, unsigned char c, id_type to) {
+    _transitions[from * alphabet + c] = to;
+  }
+
+  /**
+  \brief Adds transitions on a range of characters.
+
+  \param[in] from The source state.
+  \param[in] first The first character of the range.
+  \param[in] last The last character of the range.
+  \param[in] to The target state.
+  */
+  void add_transitions(id_type from, unsigned char first, unsigned char last, id_type to) {
+    for (std::size_t c = first; c <= last; ++c) {
+      _transitions[from * alphabet + c] = to;
+    }
+  }
+
+  /**
+  \brief Makes a state accept a token.
+
+  \param[in] state The accepting state.
+  \param[in] terminal The terminal of the token.
+  */
+  void set_token(id_type state, Symbol terminal) {
+    _accepting[state] = {terminal, LexemeKind::TOKEN};
+  }
+
+  /**
+  \brief Makes a state accept a discarded lexeme.
+
+  \param[in] state The accepting state.
+  */
+  void set_skip(id_type state) { _accepting[state] = {Symbol::eof(), LexemeKind::SKIP}; }
+
+  /**
+  \brief Get the number of states.
+  */
+  std::size_t states() const noexcept { return _accepting.size(); }
+
+  /**
+  \brief Get the target of a transition.
+
+  \param[in] state The source state.
+  \param[in] c The character.
+
+  \returns The target state. dead if there is no transition.
+  */
+  id_type next(id_type state, unsigned char c) const noexcept {
+    return _transitions[state * alphabet + c];
+  }
+
+  /**
+  \brief Matches the longest lexeme at an offset.
+
+  \param[in] input The input.
+  \param[in] begin The offset of the first character. Must be less than the input size.
+
+  \returns The longest lexeme. If no lexeme starts at begin, a single-character ERROR lexeme.
+  */
+  Lexeme match(std::string_view input, std::size_t begin) const noexcept {
+    Lexeme result{begin, begin + 1, Symbol::eof(), LexemeKind::ERROR};
+    id_type state = start;
+    for (std::size_t i = begin; i < input.size(); ++i) {
+      state = next(state, static_cast<unsigned char>(input[i]));
+      if (state == dead) {
+        break;
+      }
+      const auto& accepting = _accepting[state];
+      if (accepting.kind != LexemeKind::ERROR) {
+        result = {begin, i + 1, accepting.symbol, accepting.kind};
+      }
+    }
+    return result;
+  }
+
+  /**
+  \brief Splits the whole input into lexemes.
+
+  The input is split into chunks that are lexed concurrently, each as if a lexeme started at its
+  first character. The chunks are then joined in order: from the end of the last correct lexeme,
+  the input is lexed again sequentially only until it reaches a lexeme boundary found by the
+  chunk's own pass, from which all lexemes of that chunk are correct. The result is identical to
+  sequential lexing.
+
+  \param[in] input The input.
+  \param[in] threads The maximum number of worker threads. 0 selects the hardware concurrency.
+  \param[in] chunkSize The number of characters of a single chunk.
+
+  \returns The lexemes of the whole input, including SKIP and ERROR lexemes.
+  */
+  vector<Lexeme> lex(std::string_view input,
+                     std::size_t threads = 1,
+                     std::size_t chunkSize = default_chunk_size) const {
+    if (threads == 0) {
+      threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    chunkSize = std::max<std::size_t>(chunkSize, 1);
+    const std::size_t chunkCount = (input.size() + chunkSize - 1) / chunkSize;
+    if (threads <= 1 || chunkCount <= 1) {
+      vector<Lexeme> lexemes;
+      lex_range(input, 0, input.size(), lexemes);
+      return lexemes;
+    }
+
+    vector<Chunk> chunks(chunkCount);
+    std::atomic<std::size_t> next{0};
+    auto work = [this, input, chunkSize, &chunks, &next]() {
+      for (std::size_t i = next++; i < chunks.size(); i = next++) {
+        auto& chunk = chunks[i];
+        chunk.begin = i * chunkSize;
+        chunk.stop = std::min(chunk.begin + chunkSize, input.size());
+        chunk.end = lex_range(input, chunk.begin, chunk.stop, chunk.lexemes);
+      }
+    };
+    const std::size_t workers = std::min(threads, chunkCount);
+    vector<std::thread> workerThreads;
+    workerThreads.reserve(workers - 1);
+    for (std::size_t i = 1; i < workers; ++i) {
+      workerThreads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : workerThreads) {
+      thread.join();
+    }
+
+    // join the chunks; position is the end of the last correct lexeme
+    vector<Lexeme> lexemes;
+    std::size_t total = 0;
+    for (auto& chunk : chunks) {
+      total += chunk.lexemes.size();
+    }
+    lexemes.reserve(total);
+    std::size_t position = 0;
+    for (auto& chunk : chunks) {
+      auto it = chunk.lexemes.cbegin();
+      while (position < chunk.stop) {
+        it = std::lower_bound(
+          it, chunk.lexemes.cend(), position, [](const Lexeme& lexeme, std::size_t offset) {
+            return lexeme.begin < offset;
+          });
+        if (it != chunk.lexemes.cend() && it->begin == position) {
+          lexemes.insert(lexemes.end(), it, chunk.lexemes.cend());
+          position = chunk.end;
+          break;
+        }
+        lexemes.push_back(match(input, position));
+        position = lexemes.back().end;
+      }
+    }
+    return lexemes;
+  }
+
+  /**
+  \brief The default number of characters of a single chunk.
+  */
+  static constexpr std::size_t default_chunk_size = 1 << 16;
+
+ private:
+  static constexpr std::size_t alphabet = std::numeric_limits<unsigned char>::max() + 1;
+
+  struct Accepting {
+    Symbol symbol;
+    LexemeKind kind;
+  };
+
+  /**
+  \brief The lexemes starting in a single chunk of input.
+  */
+  struct Chunk {
+    std::size_t begin = 0;
+    std::size_t stop = 0;
+    /**
+    \brief The end of the last lexeme. May be beyond stop.
+    */
+    std::size_t end = 0;
+    vector<Lexeme> lexemes;
+  };
+
+  /**
+  \brief The transition table. Row per state, column per character.
+  */
+  vector<id_type> _transitions;
+  vector<Accepting> _accepting;
+
+  /**
+  \brief Lexes all lexemes starting before stop. The last lexeme may end beyond stop.
+
+  \returns The end of the last lexeme.
+  */
+  std::size_t lex_range(std::string_view input,
+                        std::size_t begin,
+                        std::size_t stop,
+                        vector<Lexeme>& lexemes) const {
+    while (begin < stop) {
+      lexemes.push_back(match(input, begin));
+      begin = lexemes.back().end;
+    }
+    return begin;
+  }
+};
+
+/**
+\brief Thompson's construction of a nondeterministic automaton from TokenPatterns, converted to a
+LexerDFA by the subset construction.
+*/
+class PatternNFA {
+ public:
+  /**
+  \brief Parses a pattern and adds its automaton. Patterns added earlier are preferred.
+
+  \param[in] pattern The pattern.
+  */
+  void add(const TokenPattern& pattern) {
+    _pattern = &pattern.pattern;
+    _position = 0;
+    Fragment fragment = alternation();
+    if (_position != _pattern->size()) {
+      invalid();
+    }
+    _starts.push_back(fragment.start);
+    _states[fragment.end].accepting = _accepting.size();
+    _accepting.push_back({pattern.terminal, pattern.kind});
+  }
+
+  /**
+  \brief Converts the automaton to a LexerDFA.
+  */
+  LexerDFA determinize() const {
+    LexerDFA dfa;
+    map<vector<id_type>, id_type> known;
+    vector<vector<id_type>> sets{closure(_starts)};
+    known.emplace(sets.front(), LexerDFA::start);
+    for (std::size_t i = 0; i < sets.size(); ++i) {
+      const id_type from = static_cast<id_type>(i);
+      std::size_t priority = none;
+      for (auto state : sets[i]) {
+        priority = std::min(priority, _states[state].accepting);
+      }
+      if (priority != none) {
+        const Accepting& accepting = _accepting[priority];
+        if (accepting.kind == LexemeKind::SKIP) {
+          dfa.set_skip(from);
+        } else {
+          dfa.set_token(from, accepting.terminal);
+        }
+      }
+      for (std::size_t c = 0; c < characters; ++c) {
+        vector<id_type> targets;
+        for (auto state : sets[i]) {
+          if (_states[state].characters[c]) {
+            targets.push_back(_states[state].next);
+          }
+        }
+        if (targets.empty()) {
+          continue;
+        }
+        auto [it, inserted] = known.try_emplace(closure(targets), 0);
+        if (inserted) {
+          it->second = dfa.add_state();
+          sets.push_back(it->first);
+        }
+        dfa.add_transition(from, static_cast<unsigned char>(c), it->second);
+      }
+    }
+    return dfa;
+  }
+
+ private:
+  static constexpr std::size_t characters = std::numeric_limits<unsigned char>::max() + 1;
+  static constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+
+  using CharacterSet = std::bitset<characters>;
+
+  /**
+  \brief A state with a transition on a set of characters and epsilon transitions.
+  */
+  struct State {
+    CharacterSet characters;
+    id_type next = 0;
+    vector<id_type> epsilon;
+    /**
+    \brief The priority of the accepted pattern. none if the state is not accepting.
+    */
+    std::size_t accepting = none;
+  };
+
+  /**
+  \brief A partial automaton with a single start and a single final state.
+  */
+  struct Fragment {
+    id_type start;
+    id_type end;
+  };
+
+  struct Accepting {
+    Symbol terminal;
+    LexemeKind kind;
+  };
+
+  vector<State> _states;
+  vector<id_type> _starts;
+  vector<Accepting> _accepting;
+
+  const string* _pattern = nullptr;
+  std::size_t _position = 0;
+
+  id_type add_state() {
+    _states.emplace_back();
+    return static_cast<id_type>(_states.size() - 1);
+  }
+
+  void epsilon(id_type from, id_type to) { _states[from].epsilon.push_back(to); }
+
+  Fragment fragment(const CharacterSet& set) {
+    Fragment result{add_state(), add_state()};
+    _states[result.start].characters = set;
+    _states[result.start].next = result.end;
+    return result;
+  }
+
+  vector<id_type> closure(vector<id_type> states) const {
+    vector<bool> visited(_states.size());
+    for (auto state : states) {
+      visited[state] = true;
+    }
+    for (std::size_t i = 0; i < states.size(); ++i) {
+      for (auto next : _states[states[i]].epsilon) {
+        if (!visited[next]) {
+          visited[next] = true;
+          states.push_back(next);
+        }
+      }
+    }
+    std::sort(states.begin(), states.end());
+    return states;
+  }
+
+  [[noreturn]] void invalid() const {
+    throw std::invalid_argument("Invalid lexer pattern \"" + *_pattern + "\".");
+  }
+
+  bool at_end() const noexcept { return _position == _pattern->size(); }
+
+  char peek() const noexcept { return (*_pattern)[_position]; }
+
+  Fragment alternation() {
+    Fragment first = sequence();
+    if (at_end() || peek() != '|') {
+      return first;
+    }
+    Fragment result{add_state(), add_state()};
+    epsilon(result.start, first.start);
+    epsilon(first.end, result.end);
+    while (!at_end() && peek() == '|') {
+      ++_position;
+      Fragment next = sequence();
+      epsilon(result.start, next.start);
+      epsilon(next.end, result.end);
+    }
+    return result;
+  }
+
+  Fragment sequence() {
+    id_type start = add_state();
+    Fragment result{start, start};
+    while (!at_end() && peek() != '|' && peek() != ')') {
+      Fragment next = repetition();
+      epsilon(result.end, next.start);
+      result.end = next.end;
+    }
+    return result;
+  }
+
+  Fragment repetition() {
+    Fragment result = atom();
+    while (!at_end() && (peek() == '*' || peek() == '+' || peek() == '?')) {
+      const char op = peek();
+      ++_position;
+      Fragment repeated{add_state(), add_state()};
+      epsilon(repeated.start, result.start);
+      epsilon(result.end, repeated.end);
+      if (op != '+') {
+        epsilon(repeated.start, repeated.end);
+      }
+      if (op != '?') {
+        epsilon(result.end, result.start);
+      }
+      result = repeated;
+    }
+    return result;
+  }
+
+  Fragment atom() {
+    const char c = peek();
+    ++_position;
+    switch (c) {
+      case '(': {
+        Fragment result = alternation();
+        if (at_end() || peek() != ')') {
+          invalid();
+        }
+        ++_position;
+        return result;
+      }
+      case '[':
+        return fragment(character_class());
+      case '.':
+        return fragment(CharacterSet{}.set().reset('\n'));
+      case '\\':
+        return fragment(escape());
+      case '*':
+      case '+':
+      case '?':
+      case ']':
+        invalid();
+      default:
+        return fragment(CharacterSet{}.set(static_cast<unsigned char>(c)));
+    }
+  }
+
+  /**
+  \brief Parses an escape sequence after the backslash.
+  */
+  CharacterSet escape() {
+    if (at_end()) {
+      invalid();
+    }
+    CharacterSet result;
+    const char c = peek();
+    ++_position;
+    switch (c) {
+      case 'n':
+        return result.set('\n');
+      case 't':
+        return result.set('\t');
+      case 'r':
+        return result.set('\r');
+      case 'd':
+        return range(result, '0', '9');
+      case 's':
+        for (char space : {' ', '\t', '\n', '\r', '\f', '\v'}) {
+          result.set(static_cast<unsigned char>(space));
+        }
+        return result;
+      case 'w':
+        range(result, 'a', 'z');
+        range(result, 'A', 'Z');
+        range(result, '0', '9');
+        return result.set('_');
+      default:
+        return result.set(static_cast<unsigned char>(c));
+    }
+  }
+
+  /**
+  \brief Parses a character class after the opening bracket.
+  */
+  CharacterSet character_class() {
+    CharacterSet result;
+    const bool negated = !at_end() && peek() == '^';
+    if (negated) {
+      ++_position;
+    }
+    while (!at_end() && peek() != ']') {
+      CharacterSet single;
+      if (peek() == '\\') {
+        ++_position;
+        single = escape();
+      } else {
+        single.set(static_cast<unsigned char>(peek()));
+        ++_position;
+      }
+      // a range only follows a single character
+      if (single.count() == 1 && _position + 1 < _pattern->size() && peek() == '-' &&
+          (*_pattern)[_position + 1] != ']') {
+        ++_position;
+        unsigned char first = 0;
+        while (!single[first]) {
+          ++first;
+        }
+        const auto last = static_cast<unsigned char>(peek());
+        ++_position;
+        if (last < first) {
+          invalid();
+        }
+        range(single, first, last);
+      }
+      result |= single;
+    }
+    if (at_end()) {
+      invalid();
+    }
+    ++_position;
+    return negated ? ~result : result;
+  }
+
+  static CharacterSet& range(CharacterSet& set, unsigned char first, unsigned char last) {
+    for (std::size_t c = first; c <= last; ++c) {
+      set.set(c);
+    }
+    return set;
+  }
+};
+
+inline LexerDFA LexerDFA::compile(const vector<TokenPattern>& patterns) {
+  PatternNFA nfa;
+  for (auto& pattern : patterns) {
+    nfa.add(pattern);
+  }
+  return nfa.determinize();
+}
+
+/**
+\brief Lexical analyzer driven by a LexerDFA. The whole input is read and lexed before the first
+token is returned; large inputs are lexed concurrently.
+
+SKIP lexemes are discarded. ERROR lexemes are reported as fatal errors when they are reached.
+Subclasses may override attribute() to attach attributes to tokens.
+*/
+class DFALexicalAnalyzer : public LexicalAnalyzer {
+ public:
+  /**
+  \brief Constructs the lexical analyzer.
+
+  \param[in] dfa The lexer automaton. Must outlive the lexical analyzer.
+  \param[in] threads The maximum number of worker threads. 0 selects the hardware concurrency.
+  \param[in] chunkSize The number of characters lexed by a single thread at once.
+  */
+  explicit DFALexicalAnalyzer(const LexerDFA& dfa,
+                              std::size_t threads = 1,
+                              std::size_t chunkSize = LexerDFA::default_chunk_size)
+    : _dfa(&dfa), _threads(threads), _chunkSize(chunkSize) {}
+
+ protected:
+  /**
+  \brief Returns the next lexed token.
+
+  \returns The next token.
+  */
+  Token read_token() override {
+    if (!_lexed) {
+      _input = reader()->read_all();
+      _lexemes = _dfa->lex(_input, _threads, _chunkSize);
+      _lexed = true;
+      _cursor = Location{reader()->stream_name()};
+    }
+    while (_next < _lexemes.size() && _lexemes[_next].kind == LexemeKind::SKIP) {
+      ++_next;
+    }
+    if (_next == _lexemes.size()) {
+      set_location(advance(_input.size()));
+      return token_eof();
+    }
+    const Lexeme& lexeme = _lexemes[_next++];
+    set_location(advance(lexeme.begin));
+    auto text = _input.substr(lexeme.begin, lexeme.end - lexeme.begin);
+    if (lexeme.kind == LexemeKind::ERROR) {
+      fatal_error("Unexpected character '" + string(text) + "'.");
+    }
+    return token(lexeme.symbol, attribute(lexeme.symbol, text));
+  }
+
+  /**
+  \brief Constructs the attribute of a token.
+
+  \param[in] terminal The terminal of the token.
+  \param[in] text The lexeme.
+
+  \returns The attribute of the token. The default implementation returns an empty attribute.
+  */
+  virtual Attribute attribute(Symbol terminal, std::string_view text) {
+    (void)terminal;
+    (void)text;
+    return Attribute{};
+  }
+
+  /**
+  \brief Discards the lexed input. Subclasses overriding this method must call it.
+  */
+  void reset_private() override {
+    _lexed = false;
+    _input = {};
+    _lexemes.clear();
+    _next = 0;
+    _offset = 0;
+  }
+
+ private:
+  const LexerDFA* _dfa;
+  std::size_t _threads;
+  std::size_t _chunkSize;
+
+  bool _lexed = false;
+  /**
+  \brief The input. Points into the buffer of the reader.
+  */
+  std::string_view _input;
+  vector<Lexeme> _lexemes;
+  /**
+  \brief The index of the next returned lexeme.
+  */
+  std::size_t _next = 0;
+  /**
+  \brief The location of the character at _offset. Token locations are computed incrementally.
+  */
+  Location _cursor;
+  std::size_t _offset = 0;
+
+  const Location& advance(std::size_t offset) {
+    for (; _offset < offset; ++_offset) {
+      if (_input[_offset] == '\n') {
+        ++_cursor.row;
+        _cursor.col = 1;
+      } else {
+        ++_cursor.col;
+      }
+    }
+    return _cursor;
+  }
+};
+}  // namespace ctf
+
+#endif
+
+/*** End of file ctf_dfa_lexical_analyzer.hpp ***/
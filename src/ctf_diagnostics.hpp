@@ -0,0 +1,377 @@
+/**
+\file ctf_diagnostics.hpp
+\brief Defines class DiagnosticSink, which buffers warnings and errors of a translation and renders
+them in a single write.
+\author Radek Vít
+*/
+#ifndef CTF_DIAGNOSTICS_H
+#define CTF_DIAGNOSTICS_H
+
+#include <ostream>
+#include <streambuf>
+#include <string_view>
+
+#include "ctf_base.hpp"
+#include "ctf_output_utilities.hpp"
+
+namespace ctf {
+
+/**
+\brief The severity of a diagnostic message.
+*/
+enum class Severity : unsigned char {
+  WARNING,
+  ERROR,
+};
+
+/**
+\brief The rendering formats of diagnostic messages.
+*/
+enum class DiagnosticFormat : unsigned char {
+  /**
+  \brief Text without terminal escape sequences.
+  */
+  PLAIN,
+  /**
+  \brief Text with colored severities. Identical to immediately written messages.
+  */
+  COLOR,
+  /**
+  \brief A JSON array of objects.
+  */
+  JSON,
+};
+
+/**
+\brief A single recorded diagnostic message.
+*/
+struct Diagnostic {
+  Severity severity;
+  /**
+  \brief True if the message is reported at a location.
+  */
+  bool located;
+  /**
+  \brief The index of the source name in the sink.
+  */
+  id_type source;
+  uint64_t row;
+  uint64_t col;
+  string message;
+};
+
+/**
+\brief Records diagnostic messages of a translation and renders them lazily.
+
+Source names are stored once per sink and diagnostics refer to them by index. Recording a message
+does not format its location or touch the error stream; all messages are rendered by a single
+write in render().
+*/
+class DiagnosticSink {
+ public:
+  /**
+  \brief Records a warning.
+
+  \param[in] message The message.
+  */
+  void warning(string message) { add(Severity::WARNING, std::move(message)); }
+  /**
+  \brief Records a warning at a location.
+
+  \param[in] location The location of the warning.
+  \param[in] message The message.
+  */
+  void warning(const Location& location, string message) {
+    add(Severity::WARNING, location, std::move(message));
+  }
+  /**
+  \brief Records an error.
+
+  \param[in] message The message.
+  */
+  void error(string message) { add(Severity::ERROR, std::move(message)); }
+  /**
+  \brief Records an error at a location.
+
+  \param[in] location The location of the error.
+  \param[in] message The message.
+  */
+  void error(const Location& location, string message) {
+    add(Severity::ERROR, location, std::move(message));
+  }
+
+  void add(Severity severity, string message) {
+    _diagnostics.push_back({severity, false, 0, 0, 0, std::move(message)});
+    count(severity);
+  }
+
+  void add(Severity severity, const Location& location, string message) {
+    _diagnostics.push_back({severity,
+                            true,
+                            source_id(location.fileName),
+                            location.row,
+                            location.col,
+                            std::move(message)});
+    count(severity);
+  }
+
+  /**
+  \brief Records text written directly to the error stream. The text is rendered verbatim, in
+  order with the diagnostics.
+
+  \param[in] s The text.
+  */
+  void text(std::string_view s) {
+    if (s.empty()) {
+      return;
+    }
+    if (_text.empty() || _text.back().first != _diagnostics.size()) {
+      _text.emplace_back(_diagnostics.size(), string{});
+    }
+    _text.back().second += s;
+  }
+
+  /**
+  \brief Appends all diagnostics and text from another sink.
+
+  \param[in] other The appended sink.
+  */
+  void append(const DiagnosticSink& other) {
+    auto text = other._text.begin();
+    for (std::size_t i = 0; i < other._diagnostics.size(); ++i) {
+      for (; text != other._text.end() && text->first == i; ++text) {
+        this->text(text->second);
+      }
+      auto& d = other._diagnostics[i];
+      if (d.located) {
+        _diagnostics.push_back(d);
+        _diagnostics.back().source = source_id(other._sources[d.source]);
+        count(d.severity);
+      } else {
+        add(d.severity, d.message);
+      }
+    }
+    for (; text != other._text.end(); ++text) {
+      this->text(text->second);
+    }
+  }
+
+  /**
+  \brief Removes all recorded diagnostics and text.
+  */
+  void clear() noexcept {
+    _diagnostics.clear();
+    _sources.clear();
+    _text.clear();
+    _errors = 0;
+    _warnings = 0;
+  }
+
+  const vector<Diagnostic>& diagnostics() const noexcept { return _diagnostics; }
+  const string& source(std::size_t id) const { return _sources[id]; }
+
+  bool empty() const noexcept { return _diagnostics.empty(); }
+  std::size_t errors() const noexcept { return _errors; }
+  std::size_t warnings() const noexcept { return _warnings; }
+
+  /**
+  \brief Renders all diagnostics and recorded text to a string. In the JSON format, each recorded
+  text is an object {"text": ...} in the array of diagnostics.
+
+  \param[in] format The rendering format.
+
+  \returns The rendered diagnostics.
+  */
+  string to_string(DiagnosticFormat format = DiagnosticFormat::COLOR) const {
+    string result;
+    if (format == DiagnosticFormat::JSON) {
+      render_json(result);
+      return result;
+    }
+    auto text = _text.begin();
+    const bool color = format == DiagnosticFormat::COLOR;
+    for (std::size_t i = 0; i < _diagnostics.size(); ++i) {
+      for (; text != _text.end() && text->first == i; ++text) {
+        result += text->second;
+      }
+      auto& d = _diagnostics[i];
+      if (d.located) {
+        // invalid locations are rendered as empty strings
+        if (d.row != 0 && d.col != 0) {
+          result += _sources[d.source];
+          result += ':';
+          result += std::to_string(d.row);
+          result += ':';
+          result += std::to_string(d.col);
+        }
+        result += ": ";
+      }
+      const bool error = d.severity == Severity::ERROR;
+      if (color) {
+        result += error ? output::color::red : output::color::yellow;
+      }
+      result += error ? "ERROR" : "warning";
+      if (color) {
+        result += output::reset;
+      }
+      result += ":\n";
+      result += d.message;
+      result += '\n';
+    }
+    for (; text != _text.end(); ++text) {
+      result += text->second;
+    }
+    return result;
+  }
+
+  /**
+  \brief Writes all diagnostics and recorded text to a stream in a single write.
+
+  \param[in] os The output stream.
+  \param[in] format The rendering format.
+  */
+  void render(std::ostream& os, DiagnosticFormat format = DiagnosticFormat::COLOR) const {
+    if (_diagnostics.empty() && _text.empty()) {
+      return;
+    }
+    string s = to_string(format);
+    os.write(s.data(), static_cast<std::streamsize>(s.size()));
+  }
+
+ private:
+  vector<Diagnostic> _diagnostics;
+  /**
+  \brief Source names referenced by the diagnostics.
+  */
+  vector<string> _sources;
+  /**
+  \brief Recorded text, each with the number of diagnostics recorded before it.
+  */
+  vector<pair<std::size_t, string>> _text;
+  std::size_t _errors = 0;
+  std::size_t _warnings = 0;
+
+  void count(Severity severity) noexcept {
+    if (severity == Severity::ERROR) {
+      ++_errors;
+    } else {
+      ++_warnings;
+    }
+  }
+
+  id_type source_id(const string& name) {
+    // diagnostics of a translation usually share a single source
+    for (std::size_t i = _sources.size(); i > 0; --i) {
+      if (_sources[i - 1] == name) {
+        return static_cast<id_type>(i - 1);
+      }
+    }
+    _sources.push_back(name);
+    return static_cast<id_type>(_sources.size() - 1);
+  }
+
+  static void json_string(string& result, const string& s) {
+    static const char* hex = "0123456789abcdef";
+    result += '"';
+    for (unsigned char c : s) {
+      switch (c) {
+        case '"':
+          result += "\\\"";
+          break;
+        case '\\':
+          result += "\\\\";
+          break;
+        case '\n':
+          result += "\\n";
+          break;
+        case '\t':
+          result += "\\t";
+          break;
+        case '\r':
+          result += "\\r";
+          break;
+        default:
+          if (c < 0x20) {
+            result += "\\u00";
+            result += hex[c >> 4];
+            result += hex[c & 0xf];
+          } else {
+            result += static_cast<char>(c);
+          }
+      }
+    }
+    result += '"';
+  }
+
+  void render_json(string& result) const {
+    result += '[';
+    auto text = _text.begin();
+    auto separator = [&result, first = true]() mutable {
+      result += first ? "\n  {" : ",\n  {";
+      first = false;
+    };
+    auto render_text = [&](std::size_t end) {
+      for (; text != _text.end() && text->first <= end; ++text) {
+        separator();
+        result += "\"text\": ";
+        json_string(result, text->second);
+        result += '}';
+      }
+    };
+    for (std::size_t i = 0; i < _diagnostics.size(); ++i) {
+      render_text(i);
+      auto& d = _diagnostics[i];
+      separator();
+      result += "\"severity\": ";
+      result += d.severity == Severity::ERROR ? "\"error\"" : "\"warning\"";
+      if (d.located && d.row != 0 && d.col != 0) {
+        result += ", \"source\": ";
+        json_string(result, _sources[d.source]);
+        result += ", \"row\": " + std::to_string(d.row);
+        result += ", \"col\": " + std::to_string(d.col);
+      }
+      result += ", \"message\": ";
+      json_string(result, d.message);
+      result += '}';
+    }
+    render_text(_diagnostics.size());
+    result += _diagnostics.empty() && _text.empty() ? "]\n" : "\n]\n";
+  }
+};
+
+/**
+\brief Stream buffer that records all text written to it in a DiagnosticSink, so that messages
+written directly to an error stream are rendered in order with the recorded diagnostics.
+*/
+class DiagnosticStreamBuffer : public std::streambuf {
+ public:
+  /**
+  \brief Constructs the stream buffer.
+
+  \param[in] sink The sink recording the text. Must outlive the stream buffer.
+  */
+  explicit DiagnosticStreamBuffer(DiagnosticSink& sink) : _sink(&sink) {}
+
+ protected:
+  int_type overflow(int_type c) override {
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      const char ch = traits_type::to_char_type(c);
+      _sink->text({&ch, 1});
+    }
+    return traits_type::not_eof(c);
+  }
+
+  std::streamsize xsputn(const char* s, std::streamsize n) override {
+    _sink->text({s, static_cast<std::size_t>(n)});
+    return n;
+  }
+
+ private:
+  DiagnosticSink* _sink;
+};
+
+}  // namespace ctf
+
+#endif
+
+/*** End of file ctf_diagnostics.hpp ***/
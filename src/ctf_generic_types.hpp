@@ -9,11 +9,14 @@ this project.
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <functional>
+#include <limits>
 #include <list>
 #include <map>
 #include <queue>
 #include <stack>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -26,6 +29,41 @@ TYPES
 -*/
 using std::string;
 
+/**
+\brief The storage type of symbol, state and rule identifiers.
+
+Defining CTF_NARROW_IDS before including ctf stores all identifiers in 32 bits. Symbols and LR
+actions reserve two bits for their type, limiting identifiers to 2^30 - 1.
+*/
+#ifdef CTF_NARROW_IDS
+using id_type = std::uint32_t;
+#else
+using id_type = std::size_t;
+#endif
+
+/**
+\brief The largest identifier and count of identifiers that fits in id_type together with a
+two-bit type.
+*/
+constexpr std::size_t max_id = std::numeric_limits<id_type>::max() >> 2;
+
+/**
+\brief Converts an identifier or a count of identifiers to id_type.
+
+\param[in] id The converted value.
+\param[in] what The name of the value in the exception message.
+
+\returns The value as id_type.
+
+\throws std::invalid_argument When the value is greater than max_id.
+*/
+inline id_type narrow_id(std::size_t id, const char* what) {
+  if (id > max_id) {
+    throw std::invalid_argument(string(what) + " exceeds the range of ctf::id_type.");
+  }
+  return static_cast<id_type>(id);
+}
+
 /*-
 STL
 -*/
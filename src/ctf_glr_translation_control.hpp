@@ -0,0 +1,532 @@
+/**
+\file ctf_glr_translation_control.hpp
+\brief Defines class GLRTranslationControlTemplate, which controls translations of grammars that
+are not LR(1) by generalized LR parsing.
+\author Radek Vít
+*/
+#ifndef CTF_GLR_TRANSLATION_CONTROL_H
+#define CTF_GLR_TRANSLATION_CONTROL_H
+
+#include "ctf_lr_translation_control.hpp"
+
+namespace ctf {
+
+/**
+\brief Implements generalized LR translation control.
+
+While the current state and token select a single action, the translation runs on the plain LR
+pushdown. When a cell with conflicting actions is reached, the pushdown is converted to a
+graph-structured stack and all actions are followed in parallel. Parses are recorded in a shared
+packed forest. As soon as only one stack head remains and the stack below it is linear, the
+forest of the stack is resolved and the translation continues on the LR pushdown.
+
+Ambiguities are resolved when the forest is resolved: the alternative using the rule defined
+first is selected; alternatives using the same rule prefer shorter leftmost subtrees, which
+corresponds to preferring shifts to reductions. The output of the selected parse is identical to
+the output an LR translation control would generate for that parse.
+
+\tparam GLRTableType A table providing lr_action(), lr_goto() and lr_conflicts(), such as
+GLRGenericTable.
+*/
+template <typename GLRTableType>
+class GLRTranslationControlTemplate : public LRTranslationControlTemplate<GLRTableType> {
+  using Base = LRTranslationControlTemplate<GLRTableType>;
+
+ public:
+  using typename Base::error_function;
+
+  /**
+  \brief Constructs the GLR translation control.
+  */
+  explicit GLRTranslationControlTemplate(error_function errorMessage = default_lr_error_message)
+    : Base(errorMessage) {}
+  /**
+  \brief Constructs the GLR translation control with a LexicalAnalyzer and TranslationGrammar.
+
+  \param[in] la A reference to the lexical analyzer to be used to get tokens.
+  \param[in] tg The translation grammar for this translation.
+  \param[in] to_str The symbol printing function.
+  */
+  GLRTranslationControlTemplate(LexicalAnalyzer& la,
+                                TranslationGrammar& tg,
+                                symbol_string_fn to_str = ctf::to_string) {
+    this->set_grammar(tg, to_str);
+    this->set_lexical_analyzer(la);
+  }
+
+  /**
+  \brief Runs the translation. Output symbols are stored in _output.
+  */
+  void run(const InputReader& reader, symbol_string_fn to_str = ctf::to_string) override {
+    if (!this->_lexicalAnalyzer)
+      throw TranslationException("No lexical analyzer was attached.");
+    else if (!this->_translationGrammar)
+      throw TranslationException("No translation grammar was attached.");
+
+    this->_input.clear();
+    this->_output.clear();
+    _generalizedTokens = 0;
+    _ambiguities = 0;
+
+    vector<id_type> pushdown{0};
+    vector<id_type> appliedRules{};
+
+    Token token = this->next_token();
+
+    while (true) {
+      std::size_t state = pushdown.back();
+      if (this->_lrTable.conflicted(state) &&
+          !this->_lrTable.lr_conflicts(state, token.symbol()).empty()) {
+        switch (run_generalized(pushdown, appliedRules, token, reader, to_str)) {
+          case Result::ACCEPTED:
+            this->produce_output(appliedRules);
+            return;
+          case Result::REJECTED:
+            return;
+          case Result::DETERMINISTIC:
+            continue;
+        }
+      }
+      switch (auto& item = this->_lrTable.lr_action(state, token.symbol()); item.action()) {
+        case LRAction::SHIFT:
+          pushdown.push_back(static_cast<id_type>(item.argument()));
+          token = this->next_token();
+          break;
+        case LRAction::REDUCE: {
+          auto& rule = (*this->_packedRules)[item.argument()];
+          pushdown.resize(pushdown.size() - rule.inputSize);
+          pushdown.push_back(
+            static_cast<id_type>(this->_lrTable.lr_goto(pushdown.back(), rule.nonterminal)));
+          appliedRules.push_back(static_cast<id_type>(item.argument()));
+          break;
+        }
+        case LRAction::SUCCESS:
+          appliedRules.push_back(static_cast<id_type>(this->_packedRules->size() - 1));
+          this->produce_output(appliedRules);
+          return;
+        case LRAction::ERROR:
+          this->add_error(
+            token,
+            this->_errorMessage(
+              state, token, *this->_translationGrammar, this->_lrTable, reader, to_str));
+          if (!this->error_recovery(pushdown, token))
+            return;
+      }
+    }
+  }
+
+  /**
+  \brief Get the number of tokens read on the graph-structured stack by the last translation.
+  */
+  std::size_t generalized_tokens() const noexcept { return _generalizedTokens; }
+
+  /**
+  \brief Get the number of ambiguous symbols resolved by the last translation.
+  */
+  std::size_t ambiguities() const noexcept { return _ambiguities; }
+
+ protected:
+  static constexpr id_type none = std::numeric_limits<id_type>::max();
+
+  /**
+  \brief A node of the graph-structured stack.
+  */
+  struct StackNode {
+    id_type state;
+    /**
+    \brief The position of the node. Nodes of the converted pushdown have consecutive levels;
+    each read token starts a new level.
+    */
+    id_type level;
+    vector<pair<id_type, id_type>> links;  // (lower node, forest node)
+    /**
+    \brief Set when the stack below this node is linear. Computed when the level is complete.
+    */
+    bool linear = false;
+  };
+
+  /**
+  \brief A packed alternative of a forest node.
+  */
+  struct Packed {
+    id_type rule;
+    /**
+    \brief The offset of the first child in _children.
+    */
+    id_type children;
+    id_type count;
+  };
+
+  /**
+  \brief A symbol node of the shared packed forest. Leaves have no alternatives.
+  */
+  struct ForestNode {
+    Symbol symbol;
+    id_type begin;
+    id_type end;
+    vector<Packed> alternatives;
+  };
+
+  vector<StackNode> _stack;
+  vector<ForestNode> _forest;
+  vector<id_type> _children;
+
+  std::size_t _generalizedTokens = 0;
+  std::size_t _ambiguities = 0;
+
+ private:
+  enum class Result {
+    ACCEPTED,
+    REJECTED,
+    DETERMINISTIC,
+  };
+
+  /**
+  \brief A pending reduction. If link is not none, only paths using the link of the node are
+  reduced.
+  */
+  struct Reduction {
+    id_type node;
+    id_type rule;
+    id_type linkNode;
+    id_type link;
+  };
+
+  /**
+  \brief Runs the generalized parser from the current pushdown until the input is accepted or
+  rejected or until the stack can be converted back to the pushdown. On a syntax error, the stack
+  is collapsed to the first head and error_recovery() is run on its pushdown.
+  */
+  Result run_generalized(vector<id_type>& pushdown,
+                         vector<id_type>& appliedRules,
+                         Token& token,
+                         const InputReader& reader,
+                         symbol_string_fn to_str) {
+    _stack.clear();
+    _forest.clear();
+    _children.clear();
+    // the pushdown becomes a linear stack, its symbols are leaves without rules
+    for (std::size_t i = 0; i < pushdown.size(); ++i) {
+      _stack.push_back({pushdown[i], static_cast<id_type>(i), {}, true});
+      if (i > 0) {
+        _stack.back().links.push_back({static_cast<id_type>(i - 1), leaf(Symbol::eof(), i - 1)});
+      }
+    }
+    vector<id_type> heads{static_cast<id_type>(_stack.size() - 1)};
+    id_type level = _stack.back().level;
+
+    while (true) {
+      ++_generalizedTokens;
+      std::size_t levelBegin = heads.front();
+      reduce(heads, token.symbol(), level);
+      for (std::size_t node = levelBegin; node < _stack.size(); ++node) {
+        compute_linear(static_cast<id_type>(node));
+      }
+
+      if (token.symbol() == Symbol::eof()) {
+        for (auto head : heads) {
+          if (this->_lrTable.lr_action(_stack[head].state, token.symbol()).action() ==
+              LRAction::SUCCESS) {
+            collapse(head, pushdown, appliedRules);
+            appliedRules.push_back(static_cast<id_type>(this->_packedRules->size() - 1));
+            return Result::ACCEPTED;
+          }
+        }
+      }
+
+      // shift
+      vector<id_type> shifted;
+      id_type tokenLeaf = none;
+      for (auto head : heads) {
+        for_each_action(_stack[head].state, token.symbol(), [&](const LRActionItem& action) {
+          if (action.action() != LRAction::SHIFT) {
+            return;
+          }
+          if (tokenLeaf == none) {
+            tokenLeaf = leaf(token.symbol(), level);
+          }
+          auto target = find_node(shifted, static_cast<id_type>(action.argument()));
+          if (target == none) {
+            target = static_cast<id_type>(_stack.size());
+            _stack.push_back({static_cast<id_type>(action.argument()), level + 1, {}});
+            shifted.push_back(target);
+          }
+          _stack[target].links.push_back({head, tokenLeaf});
+        });
+      }
+      if (shifted.empty()) {
+        auto state = _stack[heads.front()].state;
+        this->add_error(
+          token,
+          this->_errorMessage(
+            state, token, *this->_translationGrammar, this->_lrTable, reader, to_str));
+        // recovery continues from the pushdown of a single head, as in deterministic mode
+        collapse(heads.front(), pushdown, appliedRules);
+        return this->error_recovery(pushdown, token) ? Result::DETERMINISTIC : Result::REJECTED;
+      }
+      heads = std::move(shifted);
+      ++level;
+      token = this->next_token();
+
+      // only shift links exist on the new level, their targets are complete
+      auto& head = _stack[heads.front()];
+      if (heads.size() == 1 && head.links.size() == 1 && _stack[head.links.front().first].linear) {
+        collapse(heads.front(), pushdown, appliedRules);
+        return Result::DETERMINISTIC;
+      }
+    }
+  }
+
+  template <typename F>
+  void for_each_action(std::size_t state, Symbol terminal, F&& f) const {
+    auto& primary = this->_lrTable.lr_action(state, terminal);
+    if (primary.action() == LRAction::ERROR) {
+      return;
+    }
+    f(primary);
+    for (auto& action : this->_lrTable.lr_conflicts(state, terminal)) {
+      f(action);
+    }
+  }
+
+  id_type leaf(Symbol symbol, std::size_t begin) {
+    _forest.push_back(
+      {symbol, static_cast<id_type>(begin), static_cast<id_type>(begin + 1), {}});
+    return static_cast<id_type>(_forest.size() - 1);
+  }
+
+  id_type find_node(const vector<id_type>& nodes, id_type state) const {
+    for (auto node : nodes) {
+      if (_stack[node].state == state) {
+        return node;
+      }
+    }
+    return none;
+  }
+
+  /**
+  \brief Performs all reductions on the current level. New nodes are appended to heads.
+  */
+  void reduce(vector<id_type>& heads, Symbol terminal, id_type level) {
+    vector<Reduction> pending;
+    auto enqueue = [this, &pending, terminal](id_type node, id_type linkNode, id_type link) {
+      for_each_action(_stack[node].state, terminal, [&](const LRActionItem& action) {
+        if (action.action() != LRAction::REDUCE) {
+          return;
+        }
+        auto rule = static_cast<id_type>(action.argument());
+        // reductions through a new link only need to be repeated if they pop a symbol
+        if (link == none || (*this->_packedRules)[rule].inputSize > 0) {
+          pending.push_back({node, rule, linkNode, link});
+        }
+      });
+    };
+    // symbol nodes of this level
+    vector<id_type> symbols;
+    for (auto head : heads) {
+      enqueue(head, none, none);
+    }
+
+    vector<pair<id_type, vector<id_type>>> paths;
+    vector<id_type> path;
+    while (!pending.empty()) {
+      Reduction reduction = pending.back();
+      pending.pop_back();
+      auto& rule = (*this->_packedRules)[reduction.rule];
+
+      paths.clear();
+      path.clear();
+      find_paths(reduction.node, rule.inputSize, reduction, reduction.link == none, path, paths);
+      for (auto& [lower, children] : paths) {
+        auto begin = _stack[lower].level;
+        // the symbol node is shared by all reductions of the same nonterminal and span
+        id_type symbol = none;
+        for (auto s : symbols) {
+          if (_forest[s].symbol == rule.nonterminal && _forest[s].begin == begin) {
+            symbol = s;
+            break;
+          }
+        }
+        if (symbol == none) {
+          symbol = static_cast<id_type>(_forest.size());
+          _forest.push_back({rule.nonterminal, begin, level, {}});
+          symbols.push_back(symbol);
+        }
+        add_alternative(symbol, reduction.rule, children);
+
+        auto state =
+          static_cast<id_type>(this->_lrTable.lr_goto(_stack[lower].state, rule.nonterminal));
+        auto node = find_node(heads, state);
+        if (node == none) {
+          node = static_cast<id_type>(_stack.size());
+          _stack.push_back({state, level, {{lower, symbol}}});
+          heads.push_back(node);
+          enqueue(node, none, none);
+          continue;
+        }
+        auto& links = _stack[node].links;
+        if (std::find_if(links.begin(), links.end(), [lower = lower](auto& link) {
+              return link.first == lower;
+            }) != links.end()) {
+          // the symbol node of the link has been extended
+          continue;
+        }
+        links.push_back({lower, symbol});
+        auto link = static_cast<id_type>(links.size() - 1);
+        for (auto head : heads) {
+          enqueue(head, node, link);
+        }
+      }
+    }
+  }
+
+  /**
+  \brief Finds all paths of a given length from a node. Paths are stored with the lowest node
+  and the forest nodes of the traversed links from the left.
+  */
+  void find_paths(id_type node,
+                  std::size_t length,
+                  const Reduction& reduction,
+                  bool linkUsed,
+                  vector<id_type>& path,
+                  vector<pair<id_type, vector<id_type>>>& paths) const {
+    if (length == 0) {
+      if (linkUsed) {
+        paths.push_back({node, {path.rbegin(), path.rend()}});
+      }
+      return;
+    }
+    auto& links = _stack[node].links;
+    for (std::size_t i = 0; i < links.size(); ++i) {
+      path.push_back(links[i].second);
+      find_paths(links[i].first,
+                 length - 1,
+                 reduction,
+                 linkUsed || (node == reduction.linkNode && i == reduction.link),
+                 path,
+                 paths);
+      path.pop_back();
+    }
+  }
+
+  void add_alternative(id_type symbol, id_type rule, const vector<id_type>& children) {
+    auto& alternatives = _forest[symbol].alternatives;
+    for (auto& alternative : alternatives) {
+      if (alternative.rule == rule && alternative.count == children.size() &&
+          std::equal(children.begin(), children.end(), _children.begin() + alternative.children)) {
+        return;
+      }
+    }
+    alternatives.push_back({rule,
+                            static_cast<id_type>(_children.size()),
+                            static_cast<id_type>(children.size())});
+    _children.insert(_children.end(), children.begin(), children.end());
+  }
+
+  /**
+  \brief Computes whether the stack below a node of the current level is linear.
+  */
+  bool compute_linear(id_type node) {
+    auto& n = _stack[node];
+    if (n.links.size() != 1 || n.linear) {
+      return n.linear;
+    }
+    // links within a level may form cycles, the node is not linear until proven otherwise
+    auto lower = n.links.front().first;
+    bool linear = _stack[lower].level < n.level ? _stack[lower].linear : false;
+    _stack[node].linear = linear;
+    return linear;
+  }
+
+  /**
+  \brief Converts the stack below a node back to the pushdown and resolves the forest of its
+  symbols.
+  */
+  void collapse(id_type head, vector<id_type>& pushdown, vector<id_type>& appliedRules) {
+    vector<id_type> symbols;
+    pushdown.clear();
+    for (id_type node = head;; node = _stack[node].links.front().first) {
+      pushdown.push_back(_stack[node].state);
+      if (_stack[node].links.empty()) {
+        break;
+      }
+      symbols.push_back(_stack[node].links.front().second);
+    }
+    std::reverse(pushdown.begin(), pushdown.end());
+    vector<bool> visiting(_forest.size(), false);
+    for (auto it = symbols.rbegin(); it != symbols.rend(); ++it) {
+      resolve(*it, appliedRules, visiting);
+    }
+    _stack.clear();
+    _forest.clear();
+    _children.clear();
+  }
+
+  /**
+  \brief Appends the rules of the selected parse of a forest node in the order of an LR parser.
+  */
+  void resolve(id_type root, vector<id_type>& appliedRules, vector<bool>& visiting) {
+    struct Frame {
+      id_type node;
+      const Packed* alternative;
+      id_type next;
+    };
+    vector<Frame> frames;
+    auto push = [&](id_type node) {
+      auto& alternatives = _forest[node].alternatives;
+      const Packed* selected = nullptr;
+      for (auto& alternative : alternatives) {
+        // alternatives of cyclic grammars leading back to a visited node are skipped
+        auto first = _children.begin() + alternative.children;
+        if (std::any_of(first, first + alternative.count, [&](id_type c) { return visiting[c]; })) {
+          continue;
+        }
+        if (!selected || preferred(alternative, *selected)) {
+          selected = &alternative;
+        }
+      }
+      if (!selected) {
+        return;
+      }
+      if (alternatives.size() > 1) {
+        ++_ambiguities;
+      }
+      visiting[node] = true;
+      frames.push_back({node, selected, 0});
+    };
+
+    push(root);
+    while (!frames.empty()) {
+      auto& frame = frames.back();
+      if (frame.next < frame.alternative->count) {
+        push(_children[frame.alternative->children + frame.next++]);
+        continue;
+      }
+      appliedRules.push_back(frame.alternative->rule);
+      visiting[frame.node] = false;
+      frames.pop_back();
+    }
+  }
+
+  bool preferred(const Packed& lhs, const Packed& rhs) const {
+    if (lhs.rule != rhs.rule) {
+      return lhs.rule < rhs.rule;
+    }
+    for (id_type i = 0; i < lhs.count; ++i) {
+      auto lend = _forest[_children[lhs.children + i]].end;
+      auto rend = _forest[_children[rhs.children + i]].end;
+      if (lend != rend) {
+        return lend < rend;
+      }
+    }
+    return false;
+  }
+};
+
+using GLRTranslationControl = GLRTranslationControlTemplate<LALRGLRTable>;
+using LR1GLRTranslationControl = GLRTranslationControlTemplate<LR1GLRTable>;
+
+}  // namespace ctf
+#endif
+
+/*** End of file ctf_glr_translation_control.hpp ***/
@@ -0,0 +1,201 @@
+/**
+\file ctf_grammar_registry.hpp
+\brief Defines class GrammarRegistry, which publishes new versions of a translation grammar to
+running translations, and class VersionedLRTranslationControl.
+\author Radek Vít
+*/
+#ifndef CTF_GRAMMAR_REGISTRY_H
+#define CTF_GRAMMAR_REGISTRY_H
+
+#include <atomic>
+#include <future>
+#include <istream>
+#include <memory>
+#include <mutex>
+
+#include "ctf_lr_translation_control.hpp"
+
+namespace ctf {
+
+/**
+\brief Holds the current version of a translation grammar and its LR table.
+
+New versions are constructed by the publishing thread and installed by an atomic pointer swap.
+Translations hold a reference to the version they started with, so a published version never
+affects a running translation; the old version is released when the last translation using it
+picks up a newer one. Readers only load an atomic version counter unless a new version has been
+published.
+*/
+class GrammarRegistry {
+ public:
+  /**
+  \brief An immutable version of the grammar, its table and its packed rules.
+  */
+  struct Version {
+    /**
+    \brief The version number. Versions are numbered from 1 in the order of publishing.
+    */
+    std::uint64_t number;
+    TranslationGrammar grammar;
+    LRGenericTable table;
+    PackedRules rules;
+  };
+
+  using VersionPtr = std::shared_ptr<const Version>;
+
+  GrammarRegistry() = default;
+  GrammarRegistry(const GrammarRegistry&) = delete;
+  GrammarRegistry& operator=(const GrammarRegistry&) = delete;
+
+  /**
+  \brief Get the current version.
+
+  \returns The current version or nullptr if no version has been published.
+  */
+  VersionPtr current() const noexcept { return std::atomic_load(&_current); }
+
+  /**
+  \brief Get the number of the current version.
+
+  \returns The number of the current version. 0 if no version has been published.
+  */
+  std::uint64_t version() const noexcept { return _version.load(std::memory_order_acquire); }
+
+  /**
+  \brief Constructs the table for a grammar and publishes them as a new version.
+
+  \tparam LRTableType The LR table used to construct the table.
+  \param[in] grammar The translation grammar.
+  \param[in] to_str The symbol printing function.
+
+  \returns The published version.
+  */
+  template <typename LRTableType = LRAutoTable>
+  VersionPtr publish(TranslationGrammar grammar, symbol_string_fn to_str = ctf::to_string) {
+    LRTableType table(grammar, to_str);
+    return install(std::move(grammar), std::move(table));
+  }
+
+  /**
+  \brief Publishes a grammar with a saved table as a new version.
+
+  \param[in] grammar The translation grammar.
+  \param[in] savedTable The stream containing the table saved by LRGenericTable::save().
+
+  \returns The published version.
+  */
+  VersionPtr publish(TranslationGrammar grammar, std::istream& savedTable) {
+    return install(std::move(grammar), LRSavedTable(savedTable));
+  }
+
+  /**
+  \brief Constructs the table for a grammar in a new thread and publishes them as a new version.
+  The registry must outlive the returned future.
+
+  \tparam LRTableType The LR table used to construct the table.
+  \param[in] grammar The translation grammar.
+  \param[in] to_str The symbol printing function.
+
+  \returns A future of the published version.
+  */
+  template <typename LRTableType = LRAutoTable>
+  std::future<VersionPtr> publish_async(TranslationGrammar grammar,
+                                        symbol_string_fn to_str = ctf::to_string) {
+    return std::async(std::launch::async, [this, grammar = std::move(grammar), to_str]() mutable {
+      return publish<LRTableType>(std::move(grammar), to_str);
+    });
+  }
+
+ private:
+  /**
+  \brief The current version. Only accessed by atomic shared pointer operations.
+  */
+  VersionPtr _current;
+  /**
+  \brief The number of the current version. Updated after _current.
+  */
+  std::atomic<std::uint64_t> _version{0};
+  /**
+  \brief Orders concurrent publishers. Not used by readers.
+  */
+  std::mutex _publishMutex;
+
+  VersionPtr install(TranslationGrammar grammar, LRGenericTable table) {
+    PackedRules rules(grammar);
+    std::lock_guard<std::mutex> lock(_publishMutex);
+    std::uint64_t number = _version.load(std::memory_order_relaxed) + 1;
+    auto version = std::make_shared<const Version>(
+      Version{number, std::move(grammar), std::move(table), std::move(rules)});
+    std::atomic_store(&_current, version);
+    _version.store(version->number, std::memory_order_release);
+    return version;
+  }
+};
+
+/**
+\brief LR translation control that uses the current version of a GrammarRegistry.
+
+The version is picked up by reset(), which is called before each translation; a translation
+always finishes with the grammar and table it started with.
+*/
+class VersionedLRTranslationControl : public LRTranslationControlTemplate<LRSharedTable> {
+ public:
+  /**
+  \brief Constructs the translation control with the current version of a registry.
+
+  \param[in] registry The grammar registry. Must outlive the translation control.
+  \param[in] errFn The error message function.
+  */
+  explicit VersionedLRTranslationControl(const GrammarRegistry& registry,
+                                         error_function errFn = default_lr_error_message)
+    : LRTranslationControlTemplate<LRSharedTable>(errFn), _registry(&registry) {
+    refresh();
+  }
+
+  /**
+  \brief Resets translation state and picks up the current version of the registry.
+  */
+  void reset() noexcept override {
+    LRTranslationControlTemplate<LRSharedTable>::reset();
+    refresh();
+  }
+
+  /**
+  \brief Get the version used by the translation control.
+
+  \returns The used version or nullptr if no version had been published.
+  */
+  const GrammarRegistry::VersionPtr& version() const noexcept { return _version; }
+
+ protected:
+  /**
+  \brief The grammar is supplied by the registry.
+  */
+  void set_grammar(const TranslationGrammar&, symbol_string_fn = ctf::to_string) override {}
+
+ private:
+  const GrammarRegistry* _registry;
+  /**
+  \brief The used version. Keeps the grammar and the table alive.
+  */
+  GrammarRegistry::VersionPtr _version;
+  std::uint64_t _versionNumber = 0;
+
+  void refresh() noexcept {
+    // only the counter is read unless a new version has been published
+    if (_registry->version() == _versionNumber) {
+      return;
+    }
+    _version = _registry->current();
+    _versionNumber = _version->number;
+    _translationGrammar = &_version->grammar;
+    _packedRules = std::shared_ptr<const PackedRules>(_version, &_version->rules);
+    _lrTable = LRSharedTable(std::shared_ptr<const LRGenericTable>(_version, &_version->table));
+  }
+};
+
+}  // namespace ctf
+
+#endif
+
+/*** End of file ctf_grammar_registry.hpp ***/
@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <istream>
 #include <limits>
+#include <string_view>
 
 #include "ctf_base.hpp"
 
@@ -87,6 +88,48 @@ class InputReader {
     return get();
   }
   /**
+  \brief Gets the next character without moving the read head.
+
+  \returns The next character.
+  */
+  int peek() {
+    uint64_t row = _currentLocation.row;
+    uint64_t col = _currentLocation.col;
+    int c = get();
+    _currentLocation.row = row;
+    _currentLocation.col = col;
+    return c;
+  }
+  /**
+  \brief Skips all consecutive occurrences of a character. The rest of the current line is
+  buffered from the stream at once and scanned in place; the location is only updated once.
+
+  \param[in] c The skipped character. Must not be a newline.
+
+  \returns The number of skipped characters.
+  */
+  std::size_t skip(char c) {
+    if (!_inputBuffer.line_buffered(_currentLocation)) {
+      buffer_line();
+    }
+    std::size_t count = _inputBuffer.skip(c, _currentLocation);
+    // the rest is read from the stream, the first different character is returned
+    uint64_t row = _currentLocation.row;
+    uint64_t col = _currentLocation.col;
+    while (get() == c) {
+      row = _currentLocation.row;
+      col = _currentLocation.col;
+      ++count;
+    }
+    _currentLocation.row = row;
+    _currentLocation.col = col;
+    return count;
+  }
+  /**
+  \brief Get the location of the next read character.
+  */
+  const Location& location() const noexcept { return _currentLocation; }
+  /**
   \brief Moves the read head N characters back.
 
   \param[in] rollback How many characters to roll back.
@@ -127,6 +170,21 @@ class InputReader {
   */
   string get_all() const { return _inputBuffer.get_all(); }
 
+  /**
+  \brief Reads the rest of the input stream into the buffer in blocks. Does not move the read
+  head.
+
+  \returns A view of all buffered characters. Valid until more characters are buffered.
+  */
+  std::string_view read_all() {
+    char block[4096];
+    while (_is->read(block, sizeof(block)) || _is->gcount() > 0) {
+      _inputBuffer.append(block, static_cast<std::size_t>(_is->gcount()));
+    }
+    _inputBuffer.append(InputBuffer::eof);
+    return _inputBuffer.view();
+  }
+
   /**
   \brief Reset the reader state. This operation resets the internal position.
   */
@@ -174,6 +232,22 @@ class InputReader {
       }
     }
 
+    /**
+    \brief Appends a block of characters to the end of the buffer.
+
+    \param[in] block The first appended character.
+    \param[in] size The number of appended characters.
+    */
+    void append(const char* block, std::size_t size) {
+      const std::size_t offset = _charBuffer.size();
+      _charBuffer.insert(_charBuffer.end(), block, block + size);
+      for (std::size_t i = 0; i < size; ++i) {
+        if (block[i] == '\n') {
+          _lineStartBuffer.push_back(offset + i + 1);
+        }
+      }
+    }
+
     /**
     \brief Reads a character and moves a location to its next position.
 
@@ -196,6 +270,38 @@ class InputReader {
       return true;
     }
 
+    /**
+    \brief Checks whether a line has been buffered up to its end.
+
+    \param[in] location A location on the line.
+
+    \returns True if the line's newline or EOF has been buffered.
+    */
+    bool line_buffered(const Location& location) const noexcept {
+      return line(location) + 1 < _lineStartBuffer.size() ||
+             _eofLocation != std::numeric_limits<std::size_t>::max();
+    }
+
+    /**
+    \brief Skips buffered consecutive occurrences of a character on the current line.
+
+    \param[in] c The skipped character.
+    \param[in,out] location The next location to be read.
+
+    \returns The number of skipped characters.
+    */
+    std::size_t skip(char c, Location& location) const noexcept {
+      auto begin = character(location);
+      auto end = line_end(line(location));
+      auto it = begin;
+      while (it < end && *it == c) {
+        ++it;
+      }
+      std::size_t count = it - begin;
+      location.col += count;
+      return count;
+    }
+
     /**
     \brief Returns a line of characters.
 
@@ -221,6 +327,10 @@ class InputReader {
     */
     string get_all() const { return transform<vector<char>, string>(_charBuffer); }
     /**
+    \brief Get a view of all read characters.
+    */
+    std::string_view view() const noexcept { return {_charBuffer.data(), _charBuffer.size()}; }
+    /**
     \brief Returns the location after n-character rollback from a previous
     location.
 
@@ -364,6 +474,23 @@ class InputReader {
   \brief The input buffer object. Stores all read characters.
   */
   InputBuffer _inputBuffer;
+  /**
+  \brief Holds lines read by buffer_line(). Kept to reuse its storage.
+  */
+  string _line;
+
+  /**
+  \brief Reads the rest of the current line from the stream into the buffer. EOF is buffered when
+  the stream ends on the line.
+  */
+  void buffer_line() {
+    if (!std::getline(*_is, _line)) {
+      _inputBuffer.append(InputBuffer::eof);
+      return;
+    }
+    _inputBuffer.append(_line.data(), _line.size());
+    _inputBuffer.append(_is->eof() ? InputBuffer::eof : '\n');
+  }
 };
 
 }  // namespace ctf
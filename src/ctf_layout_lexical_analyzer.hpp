@@ -0,0 +1,174 @@
+/**
+\file ctf_layout_lexical_analyzer.hpp
+\brief Defines class LayoutLexicalAnalyzer, which generates indentation tokens for
+indentation-sensitive languages.
+\author Radek Vít
+*/
+#ifndef CTF_LAYOUT_LEXICAL_ANALYZER_H
+#define CTF_LAYOUT_LEXICAL_ANALYZER_H
+
+#include "ctf_lexical_analyzer.hpp"
+
+namespace ctf {
+
+/**
+\brief The character used for indentation.
+*/
+enum class Indentation : unsigned char {
+  TABS,
+  SPACES,
+};
+
+/**
+\brief Lexical analyzer base class for languages with Python-style layout.
+
+Each newline token is followed by indent tokens for each level the indentation of the next line
+increases or dedent tokens for each level it decreases. The leading indentation of a line is
+scanned at once and the indentation tokens are returned from a queue before any other token is
+read.
+
+Subclasses implement read_layout_token() and return token_newline() whenever they read a newline
+character.
+*/
+class LayoutLexicalAnalyzer : public LexicalAnalyzer {
+ public:
+  /**
+  \brief Constructs the lexical analyzer with the layout symbols.
+
+  \param[in] newline The newline terminal.
+  \param[in] indent The indent terminal.
+  \param[in] dedent The dedent terminal.
+  \param[in] indentation The indentation character.
+  \param[in] width The number of indentation characters of a single indentation level.
+  */
+  LayoutLexicalAnalyzer(Symbol newline,
+                        Symbol indent,
+                        Symbol dedent,
+                        Indentation indentation = Indentation::TABS,
+                        std::size_t width = 1)
+    : _newline(newline)
+    , _indent(indent)
+    , _dedent(dedent)
+    , _indentation(indentation)
+    , _width(width == 0 ? 1 : width) {}
+
+  /**
+  \brief Get the current indentation level.
+  */
+  std::size_t level() const noexcept { return _level; }
+
+ protected:
+  /**
+  \brief Returns queued indentation tokens or reads a new token.
+
+  \returns A token from the input stream.
+  */
+  Token read_token() final {
+    if (_pending > 0) {
+      --_pending;
+      return _pendingToken;
+    }
+    if (_pendingEof) {
+      _pendingEof = false;
+      return Token(Symbol::eof(), Attribute{}, _pendingToken.location());
+    }
+    return read_layout_token();
+  }
+
+  /**
+  \brief Reads a single token. Called when there are no queued indentation tokens.
+
+  \returns A token from the input stream.
+  */
+  virtual Token read_layout_token() = 0;
+
+  /**
+  \brief Constructs the newline token and queues the indentation tokens of the next line.
+
+  Must be called right after the newline character has been read. The indentation tokens are
+  located at the start of the next line.
+
+  \returns The newline token.
+  */
+  Token token_newline() {
+    Token nl = token(_newline);
+    reset_location();
+    const char unit = _indentation == Indentation::TABS ? '\t' : ' ';
+    std::size_t count = skip(unit);
+    if (peek() == (_indentation == Indentation::TABS ? ' ' : '\t')) {
+      warning(_indentation == Indentation::TABS
+                ? "Spaces are not allowed at the start of a new line."
+                : "Tabs are not allowed at the start of a new line.");
+    }
+    if (count % _width != 0) {
+      warning("Indentation is not a multiple of " + std::to_string(_width) +
+              (unit == '\t' ? " tabs." : " spaces."));
+    }
+    std::size_t level = count / _width;
+    if (level < _level) {
+      queue(_dedent, _level - level);
+    } else if (level > _level) {
+      queue(_indent, level - _level);
+    }
+    _level = level;
+    return nl;
+  }
+
+  /**
+  \brief Queues dedent tokens for all open indentation levels followed by the EOF token.
+
+  \returns The first queued token.
+  */
+  Token token_layout_eof() {
+    if (_level == 0) {
+      return token_eof();
+    }
+    queue(_dedent, _level);
+    _level = 0;
+    _pendingEof = true;
+    --_pending;
+    return _pendingToken;
+  }
+
+  /**
+  \brief Resets the indentation state. Subclasses overriding this method must call it.
+  */
+  void reset_private() override {
+    _level = 0;
+    _pending = 0;
+    _pendingEof = false;
+  }
+
+ private:
+  Symbol _newline;
+  Symbol _indent;
+  Symbol _dedent;
+  Indentation _indentation;
+  /**
+  \brief The number of indentation characters of a single level.
+  */
+  std::size_t _width;
+  /**
+  \brief The indentation level of the current line.
+  */
+  std::size_t _level = 0;
+  /**
+  \brief The number of queued indentation tokens. All queued tokens are identical.
+  */
+  std::size_t _pending = 0;
+  Token _pendingToken = Symbol::eof();
+  /**
+  \brief Set when the EOF token follows the queued tokens.
+  */
+  bool _pendingEof = false;
+
+  void queue(Symbol s, std::size_t count) {
+    _pendingToken = token(s);
+    _pending = count;
+  }
+};
+}  // namespace ctf
+
+#endif
+
+/*** End of file ctf_layout_lexical_analyzer.hpp ***/
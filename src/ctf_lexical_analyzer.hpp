@@ -12,6 +12,7 @@
 #include <ostream>
 
 #include "ctf_base.hpp"
+#include "ctf_diagnostics.hpp"
 #include "ctf_input_reader.hpp"
 #include "ctf_output_utilities.hpp"
 
@@ -91,6 +92,18 @@ class LexicalAnalyzer {
   */
   void set_error_stream(std::ostream& os) { _error = &os; }
 
+  /**
+  \brief Set the diagnostic sink. Warnings and errors are recorded in the sink instead of being
+  written to the error stream.
+
+  \param[in] sink The diagnostic sink to be set.
+  */
+  void set_diagnostics(DiagnosticSink& sink) noexcept { _diagnostics = &sink; }
+  /**
+  \brief Removes the diagnostic sink. Warnings and errors are written to the error stream.
+  */
+  void remove_diagnostics() noexcept { _diagnostics = nullptr; }
+
  protected:
   /**
   \brief Gets next Symbol from stream. Sets error flag on error.
@@ -162,6 +175,35 @@ class LexicalAnalyzer {
   */
   void unget(std::size_t num = 1) { reader_->unget(num); }
 
+  /**
+  \brief Get the next character without reading it.
+
+  \returns The int value of the next character.
+  */
+  int peek() { return reader_->peek(); }
+
+  /**
+  \brief Sets the current token location if not yet specified and skips all consecutive
+  occurrences of a character.
+
+  \param[in] c The skipped character. Must not be a newline.
+
+  \returns The number of skipped characters.
+  */
+  std::size_t skip(char c) {
+    if (_location == Location::invalid()) {
+      _location = reader_->location();
+    }
+    return reader_->skip(c);
+  }
+
+  /**
+  \brief Get the assigned reader.
+
+  \returns A pointer to the assigned reader. nullptr if no reader is assigned.
+  */
+  InputReader* reader() const noexcept { return reader_; }
+
   /**
   \brief Resets the current token's location.
   */
@@ -172,6 +214,12 @@ class LexicalAnalyzer {
   \returns A const reference to the current location.
   */
   const Location& location() const noexcept { return _location; }
+  /**
+  \brief Sets the current stored location.
+
+  \param[in] location The location of the current token.
+  */
+  void set_location(const Location& location) { _location = location; }
 
   /**
   \brief Constructs a token and inserts the current symbol location
@@ -214,6 +262,10 @@ class LexicalAnalyzer {
   it.
   */
   void warning(const string& message) {
+    if (_diagnostics) {
+      _diagnostics->warning(_location, message);
+      return;
+    }
     err() << _location.to_string() << ": " << output::color::yellow << "warning" << output::reset
           << ":\n"
           << message << "\n";
@@ -223,10 +275,14 @@ class LexicalAnalyzer {
   it and sets the error flag.
   */
   void error(const string& message) {
+    set_error();
+    if (_diagnostics) {
+      _diagnostics->error(_location, message);
+      return;
+    }
     err() << _location.to_string() << ": " << output::color::red << "ERROR" << output::reset
           << ":\n"
           << message << "\n";
-    set_error();
   }
   /**
   \brief Outputs an error message with the location automatically printed before
@@ -259,6 +315,11 @@ class LexicalAnalyzer {
   */
   std::ostream* _error = nullptr;
 
+  /**
+  \brief The diagnostic sink. Messages are written to the error stream if not set.
+  */
+  DiagnosticSink* _diagnostics = nullptr;
+
   /**
   \brief Error flag. This flag should be set by subclasses on invalid input.
   */
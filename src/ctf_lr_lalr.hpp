@@ -23,8 +23,7 @@ class StateMachine : public ctf::lr1::StateMachine {
   */
   StateMachine(const TranslationGrammar& grammar) : ctf::lr1::StateMachine(grammar, true) {
     // initial item S' -> .S$
-    insert_state({Item(
-      {grammar.starting_rule(), 0}, {}, lr1::LookaheadSet(grammar.terminals(), {Symbol::eof()}))});
+    insert_state({initial_item()});
     // recursively expand all states: dfs
     expand_state(0);
     // push all lookaheads to their items
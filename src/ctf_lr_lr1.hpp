@@ -41,6 +41,103 @@ struct LookaheadSource {
 };
 
 using LookaheadSet = TerminalSet;
+
+/**
+\brief Interns lookahead sets. Identical sets share a single immutable instance referenced by id.
+
+The results of set unions are memoized by the ids of their operands. All sets in a pool have the
+same capacity.
+*/
+class LookaheadSetPool {
+ public:
+  /**
+  \brief The id of the empty set.
+  */
+  static constexpr id_type empty = 0;
+
+  /**
+  \brief Constructs a pool containing only the empty set.
+
+  \param[in] terminals The capacity of all sets.
+  */
+  explicit LookaheadSetPool(std::size_t terminals) { intern(LookaheadSet(terminals)); }
+
+  LookaheadSetPool(const LookaheadSetPool&) = delete;
+  LookaheadSetPool& operator=(const LookaheadSetPool&) = delete;
+
+  /**
+  \brief Get the set with the given id.
+  */
+  const LookaheadSet& operator[](id_type id) const noexcept { return _sets[id]; }
+
+  /**
+  \brief Get the number of distinct sets.
+  */
+  std::size_t size() const noexcept { return _sets.size(); }
+
+  /**
+  \brief Get the id of a set, inserting it if it is not present.
+
+  \param[in] set The interned set.
+
+  \returns The id of the set.
+  */
+  id_type intern(LookaheadSet set) {
+    auto& bucket = _ids[std::hash<bit_set>{}(set)];
+    for (auto id : bucket) {
+      if (_sets[id] == set) {
+        return id;
+      }
+    }
+    auto id = narrow_id(_sets.size(), "The number of lookahead sets");
+    _sets.push_back(std::move(set));
+    bucket.push_back(id);
+    return id;
+  }
+
+  /**
+  \brief Get the id of the union of two sets.
+
+  \param[in] lhs The id of the first set.
+  \param[in] rhs The id of the second set.
+
+  \returns The id of the union.
+  */
+  id_type set_union(id_type lhs, id_type rhs) {
+    if (lhs == rhs || rhs == empty) {
+      return lhs;
+    }
+    if (lhs == empty) {
+      return rhs;
+    }
+    if (rhs < lhs) {
+      std::swap(lhs, rhs);
+    }
+    auto key = (static_cast<std::uint64_t>(lhs) << 32) | static_cast<std::uint64_t>(rhs);
+    auto [it, inserted] = _unions.try_emplace(key, empty);
+    if (inserted) {
+      LookaheadSet result(_sets[lhs]);
+      result |= _sets[rhs];
+      // the iterator is not invalidated by interning
+      it->second = intern(std::move(result));
+    }
+    return it->second;
+  }
+
+ private:
+  /**
+  \brief The distinct sets. References stay valid when new sets are interned.
+  */
+  deque<LookaheadSet> _sets;
+  /**
+  \brief Set ids by the hashes of the sets.
+  */
+  unordered_map<std::size_t, vector<id_type>> _ids;
+  /**
+  \brief Memoized unions keyed by both operand ids. The smaller id is in the upper half.
+  */
+  unordered_map<std::uint64_t, id_type> _unions;
+};
 }  // namespace ctf::lr1
 
 namespace std {
@@ -65,27 +162,22 @@ class Item {
   /**
   \brief Constructs the item with empty lookahead sets.
   */
-  Item(const LR0Item& item, const TranslationGrammar& tg)
-    : _item(item), _generatedLookaheads(tg.terminals()) {}
+  explicit Item(const LR0Item& item) : _item(item) {}
   /**
   \brief Constructs the item with empty lookahead sets.
   */
-  Item(LR0Item&& item, const TranslationGrammar& tg)
-    : _item(std::move(item)), _generatedLookaheads(tg.terminals()) {}
+  explicit Item(LR0Item&& item) : _item(std::move(item)) {}
   /**
   \brief Constructs the item with a supplied lookahead source and generated lookahead sets.
+
+  \param[in] item The LR(0) item.
+  \param[in] lookaheads The lookahead sources.
+  \param[in] generatedLookaheads The id of the generated lookahead set in a LookaheadSetPool.
   */
   Item(const LR0Item& item,
        const vector_set<LookaheadSource>& lookaheads,
-       const LookaheadSet& generatedLookaheads)
+       id_type generatedLookaheads)
     : _item(item), _lookaheads(lookaheads), _generatedLookaheads(generatedLookaheads) {}
-  /**
-  \brief Constructs the item with a supplied lookahead source and generated lookahead sets.
-  */
-  Item(const LR0Item& item,
-       const vector_set<LookaheadSource>& lookaheads,
-       LookaheadSet&& generatedLookaheads)
-    : _item(item), _lookaheads(lookaheads), _generatedLookaheads(std::move(generatedLookaheads)) {}
 
   Item(const Item& item) = default;
   Item(Item&& item) = default;
@@ -109,17 +201,13 @@ class Item {
   */
   LR0Item&& lr0_item() && noexcept { return std::move(_item); }
   /**
-  \brief Returns the set of generated lookaheads of this item.
-  */
-  LookaheadSet& lookaheads() & noexcept { return _generatedLookaheads; }
-  /**
-  \brief Returns the set of generated lookaheads of this item.
+  \brief Returns the id of the set of generated lookaheads of this item.
   */
-  const LookaheadSet& lookaheads() const& noexcept { return _generatedLookaheads; }
+  id_type lookaheads() const noexcept { return _generatedLookaheads; }
   /**
-  \brief Returns the set of generated lookaheads of this item.
+  \brief Sets the id of the set of generated lookaheads of this item.
   */
-  LookaheadSet&& lookaheads() && noexcept { return std::move(_generatedLookaheads); }
+  void set_lookaheads(id_type lookaheads) noexcept { _generatedLookaheads = lookaheads; }
 
   /**
   \brief Returns the set of lookahead sources of this item.
@@ -151,17 +239,17 @@ class Item {
     vector_set<LookaheadSource> lookaheads;
     lookaheads.insert(las);
 
-    return Item(_item.next(), lookaheads, LookaheadSet(_generatedLookaheads.capacity()));
+    return Item(_item.next(), lookaheads, LookaheadSetPool::empty);
   }
 
   friend bool operator<(const Item& lhs, const Item& rhs) { return lhs._item < rhs._item; }
 
   friend bool operator==(const Item& lhs, const Item& rhs) { return lhs._item == rhs._item; }
 
-  string to_string(symbol_string_fn to_str = ctf::to_string) const {
+  string to_string(const LookaheadSetPool& pool, symbol_string_fn to_str = ctf::to_string) const {
     using namespace std::literals;
     string result = "["s + _item.to_string(to_str) + ", {";
-    for (auto& symbol : lookaheads().symbols()) {
+    for (auto& symbol : pool[lookaheads()].symbols()) {
       result += ' ';
       result += to_str(symbol);
     }
@@ -176,8 +264,6 @@ class Item {
     return result;
   }
 
-  explicit operator string() const { return to_string(); }
-
  private:
   /**
   \brief The LR(0) item of this LS item.
@@ -188,9 +274,9 @@ class Item {
   */
   vector_set<LookaheadSource> _lookaheads;
   /**
-  \brief The set of generated lookaheads of this LS item.
+  \brief The id of the set of generated lookaheads of this LS item.
   */
-  LookaheadSet _generatedLookaheads;
+  id_type _generatedLookaheads = LookaheadSetPool::empty;
 };
 
 /**
@@ -244,13 +330,15 @@ inline FirstResult first(const vector<Symbol>& symbols,
 \param[in] grammar The translation grammar.
 \param[in] e The empty set for all nonterminals.
 \param[in] f The first set for all nonterminals.
+\param[in,out] pool The pool of lookahead sets.
 
 \returns The closure of parameter items.
 */
 inline vector_set<Item> closure(vector_set<Item> items,
                                 const TranslationGrammar& grammar,
                                 const empty_t& e,
-                                const first_t& f) {
+                                const first_t& f,
+                                LookaheadSetPool& pool) {
   vector_set<Item> closure{items};
 
   vector_set<Item> newItems;
@@ -265,11 +353,12 @@ inline vector_set<Item> closure(vector_set<Item> items,
         if (!item.reduce()) {
           followingSymbols = {input.begin() + item.mark() + 1, input.end()};
         }
-        auto [generatedLookaheads, propagateLookahead] = first(followingSymbols, e, f, grammar);
+        auto [firstSymbols, propagateLookahead] = first(followingSymbols, e, f, grammar);
+        id_type generatedLookaheads = pool.intern(std::move(firstSymbols));
         vector_set<LookaheadSource> propagatedLookaheads;
         if (propagateLookahead) {
           propagatedLookaheads = item.lookahead_sources();
-          generatedLookaheads |= item.lookaheads();
+          generatedLookaheads = pool.set_union(generatedLookaheads, item.lookaheads());
         }
         // TODO optimization point
         for (auto& rule : grammar.rules()) {
@@ -279,7 +368,9 @@ inline vector_set<Item> closure(vector_set<Item> items,
             if (it != closure.end()) {
               std::size_t originalSize = it->lookahead_sources().size();
               it->lookahead_sources() = set_union(it->lookahead_sources(), propagatedLookaheads);
-              bool addedGenerated = it->lookaheads().set_union(generatedLookaheads);
+              id_type lookaheads = pool.set_union(it->lookaheads(), generatedLookaheads);
+              bool addedGenerated = lookaheads != it->lookaheads();
+              it->set_lookaheads(lookaheads);
               std::size_t newSize = it->lookahead_sources().size();
               if (newSize > originalSize || addedGenerated) {
                 // TODO would it ultimately be faster to create in-state lookahead sources instead?
@@ -344,13 +435,15 @@ class StateMachine {
     \param[in] grammar The translation grammar of this state.
     \param[in] empty The empty set for all nonterminals.
     \param[in] first The first set for all terminals.
+    \param[in,out] pool The pool of lookahead sets of the automaton.
     */
     State(std::size_t id,
           const vector_set<Item>& kernel,
           const TranslationGrammar& grammar,
           const empty_t& empty,
-          const first_t& first)
-      : _id(id), _items(closure(kernel, grammar, empty, first)) {
+          const first_t& first,
+          LookaheadSetPool& pool)
+      : _id(id), _items(closure(kernel, grammar, empty, first, pool)), _pool(&pool) {
       // we can only merge states when the kernel contains a rule in the form A -> x.Y
       for (auto& item : _items) {
         if (item.reduce()) {
@@ -386,11 +479,18 @@ class StateMachine {
     */
     bool has_reduce() const noexcept { return _reduce; }
 
+    /**
+    \brief Get the set of lookaheads of an item of this state.
+    */
+    const LookaheadSet& lookahead_set(const Item& item) const noexcept {
+      return (*_pool)[item.lookaheads()];
+    }
+
     string to_string(symbol_string_fn to_str = ctf::to_string) const {
       string result = std::to_string(id()) + ": {\n";
       for (auto& item : items()) {
         result += '\t';
-        result += item.to_string(to_str) + '\n';
+        result += item.to_string(*_pool, to_str) + '\n';
       }
       result += "\t-----\n";
       for (auto& [symbol, next] : transitions()) {
@@ -413,6 +513,11 @@ class StateMachine {
     */
     vector_set<Item> _items;
 
+    /**
+    \brief The pool of lookahead sets referenced by the items.
+    */
+    const LookaheadSetPool* _pool;
+
     /**
     \brief The GOTO transition map.
     */
@@ -428,21 +533,32 @@ class StateMachine {
   \param[in] grammar The translation grammar.
   */
   StateMachine(const TranslationGrammar& grammar)
-    : _grammar(&grammar), _empty(create_empty(grammar)), _first(create_first(grammar, _empty)) {
+    : _grammar(&grammar)
+    , _empty(create_empty(grammar))
+    , _first(create_first(grammar, _empty))
+    , _pool(grammar.terminals()) {
     // initial item S' -> .S$
-    insert_state(
-      {Item({grammar.starting_rule(), 0}, {}, LookaheadSet(grammar.terminals(), {Symbol::eof()}))});
+    insert_state({initial_item()});
     // recursively expand all states: dfs
     expand_state(0);
     // push all lookaheads to their items
   }
 
+  // states reference the lookahead set pool
+  StateMachine(const StateMachine&) = delete;
+  StateMachine& operator=(const StateMachine&) = delete;
+
   virtual ~StateMachine() = default;
   /**
   \brief Get the states of this state machine.
   */
   const vector<State>& states() const noexcept { return _states; }
 
+  /**
+  \brief Get the pool of lookahead sets referenced by the items.
+  */
+  const LookaheadSetPool& lookahead_pool() const noexcept { return _pool; }
+
  protected:
   /**
   \brief A pointer to the translation grammar.
@@ -457,6 +573,10 @@ class StateMachine {
   */
   first_t _first;
   /**
+  \brief The interned lookahead sets of all items.
+  */
+  LookaheadSetPool _pool;
+  /**
   \brief The states of the LS automaton.
   */
   vector<State> _states;
@@ -485,12 +605,23 @@ class StateMachine {
   calculate predictive sets.
   */
   StateMachine(const TranslationGrammar& grammar, bool)
-    : _grammar(&grammar), _empty(create_empty(grammar)), _first(create_first(grammar, _empty)) {}
+    : _grammar(&grammar)
+    , _empty(create_empty(grammar))
+    , _first(create_first(grammar, _empty))
+    , _pool(grammar.terminals()) {}
   /**
   \brief Get the referenced translation grammar.
   */
   const TranslationGrammar& grammar() const noexcept { return *_grammar; }
   /**
+  \brief Get the initial item S' -> .S$.
+  */
+  Item initial_item() {
+    return Item({grammar().starting_rule(), 0},
+                {},
+                _pool.intern(LookaheadSet(grammar().terminals(), {Symbol::eof()})));
+  }
+  /**
   \brief Insert a state into the automaton.
 
   \param[in] kernel The kernel of the new state.
@@ -501,7 +632,7 @@ class StateMachine {
   */
   InsertResult insert_state(const vector_set<Item>& kernel) {
     std::size_t i = _states.size();
-    State newState(i, kernel, grammar(), _empty, _first);
+    State newState(i, kernel, grammar(), _empty, _first, _pool);
 
     // try to merge with another state
     auto& kernelStates = _kernelMap[kernel];
@@ -525,7 +656,8 @@ class StateMachine {
     auto newLookaheads = lookaheads(newState);
     for (std::size_t i = 0; i < newState.items().size(); ++i) {
       auto& item = newState.items()[i];
-      item.lookaheads() |= newLookaheads[i];
+      // the full lookahead set contains the generated lookaheads
+      item.set_lookaheads(newLookaheads[i]);
       item.lookahead_sources().clear();
       item.lookahead_sources().shrink_to_fit();
     }
@@ -533,6 +665,7 @@ class StateMachine {
       auto& existing = _states[other];
       bool merge = true;
       for (std::size_t i = 0; i < existing.items().size(); ++i) {
+        // interned sets are equal if their ids are equal
         if (newState.items()[i].lookaheads() != existing.items()[i].lookaheads()) {
           merge = false;
           break;
@@ -553,26 +686,25 @@ class StateMachine {
 
   \param[in] state The LS state we are examining.
 
-  \returns A full set of lookahead symbols for this state.
+  \returns The ids of the full lookahead sets of all items of this state.
   */
-  vector<LookaheadSet> lookaheads(const State& state) {
+  vector<id_type> lookaheads(const State& state) {
     // get all back references
-    unordered_map<LookaheadSource, LookaheadSet> lookaheadMap;
-    vector<LookaheadSet> result;
+    unordered_map<LookaheadSource, id_type> lookaheadMap;
+    vector<id_type> result;
 
     // get all sources
     for (auto& item : state.items()) {
       result.push_back(item.lookaheads());
       for (auto& source : item.lookahead_sources()) {
-        unordered_map<LookaheadSource, LookaheadSet> tempMap(lookaheadMap);
         auto it = lookaheadMap.find(source);
         if (it == lookaheadMap.end()) {
-          // lookahead source not resolved
+          // lookahead source not resolved, partial results of cycles are not kept
+          unordered_map<LookaheadSource, id_type> tempMap(lookaheadMap);
           lookahead_lookup(source, tempMap);
-          it = tempMap.find(source);
-          lookaheadMap.insert_or_assign(it->first, it->second);
+          it = lookaheadMap.insert_or_assign(source, tempMap[source]).first;
         }
-        result.back() |= it->second;
+        result.back() = _pool.set_union(result.back(), it->second);
       }
     }
     return result;
@@ -581,13 +713,13 @@ class StateMachine {
   \brief Lookup of lookahead symbols from a source. Avoids infinite loops.
   */
   void lookahead_lookup(const LookaheadSource& source,
-                        unordered_map<LookaheadSource, LookaheadSet>& lookaheadMap) {
+                        unordered_map<LookaheadSource, id_type>& lookaheadMap) {
     const auto& state = _states[source.state];
     // stop infinite loops
-    lookaheadMap.insert_or_assign(source, LookaheadSet(grammar().terminals()));
+    lookaheadMap.insert_or_assign(source, LookaheadSetPool::empty);
     // get all sources
     auto& item = state.items()[source.item];
-    LookaheadSet symbols(item.lookaheads());
+    id_type symbols = item.lookaheads();
     for (auto& nextSource : item.lookahead_sources()) {
       auto it = lookaheadMap.find(nextSource);
       if (it == lookaheadMap.end()) {
@@ -595,9 +727,9 @@ class StateMachine {
         lookahead_lookup(nextSource, lookaheadMap);
         it = lookaheadMap.find(nextSource);
       }
-      symbols |= it->second;
+      symbols = _pool.set_union(symbols, it->second);
     }
-    lookaheadMap.insert_or_assign(source, std::move(symbols));
+    lookaheadMap.insert_or_assign(source, symbols);
   }
   /**
   \brief Expands a state and generates and expands its successors.
@@ -622,7 +754,7 @@ class StateMachine {
   void finalize_lookaheads() {
     // a single map for all lookaheads
     for (auto& state : _states) {
-      unordered_map<LookaheadSource, LookaheadSet> lookaheadMap;
+      unordered_map<LookaheadSource, id_type> lookaheadMap;
       for (auto& item : state.items()) {
         for (auto& source : item.lookahead_sources()) {
           auto it = lookaheadMap.find(source);
@@ -631,7 +763,7 @@ class StateMachine {
             lookahead_lookup(source, lookaheadMap);
             it = lookaheadMap.find(source);
           }
-          item.lookaheads() |= it->second;
+          item.set_lookaheads(_pool.set_union(item.lookaheads(), it->second));
           // TODO set lookup in map
         }
         // remove all relative lookaheads from this item
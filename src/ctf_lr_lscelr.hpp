@@ -50,8 +50,7 @@ class StateMachine : public ctf::lalr::StateMachine {
   */
   StateMachine(const TranslationGrammar& grammar) : ctf::lalr::StateMachine(grammar, true) {
     // initial item S' -> .S$
-    insert_state({Item(
-      {grammar.starting_rule(), 0}, {}, lr1::LookaheadSet(grammar.terminals(), {Symbol::eof()}))});
+    insert_state({initial_item()});
     // recursively expand all states: dfs
     expand_state(0);
     // identify states with conflicts
@@ -79,11 +78,11 @@ class StateMachine : public ctf::lalr::StateMachine {
   */
   vector_set<std::size_t> _statesToSplit;
   /**
-  \brief The set of lookaheads that contribute to conflicts for states that have them.
+  \brief The ids of the sets of lookaheads that contribute to conflicts for states that have them.
 
   This serves as cache so that we don't recompute the set for every attempt to merge.
   */
-  vector<std::optional<vector<vector<LookaheadSet>>>> _contributionLookaheads;
+  vector<std::optional<vector<vector<id_type>>>> _contributionLookaheads;
   /**
   \brief A single conflict. Contains the state where it manifests and the conflicted symbols for
   each item.
@@ -122,17 +121,17 @@ class StateMachine : public ctf::lalr::StateMachine {
   \brief Obtain all conflicts for a single state.
 
   \param[in] state The examined state.
-  \param[in] stateLookaheads The full lookahead set of the state.
+  \param[in] stateLookaheads The ids of the full lookahead sets of the state.
 
   \returns A map where the keys are item indices and the values are the conflicted terminals.
   */
   unordered_map<std::size_t, LookaheadSet> conflicts(State& state,
-                                                     const vector<LookaheadSet>& stateLookaheads) {
+                                                     const vector<id_type>& stateLookaheads) {
     unordered_map<std::size_t, LookaheadSet> result;
     vector<tuple<Action, std::size_t>> actions(grammar().terminals(), {Action::NONE, 0});
     for (std::size_t i = 0; i < state.items().size(); ++i) {
       auto& item = state.items()[i];
-      auto& lookahead = stateLookaheads[i];
+      auto& lookahead = _pool[stateLookaheads[i]];
       if (item.reduce()) {
         for (auto& symbol : lookahead.symbols()) {
           auto& [action, item] = actions[symbol.id()];
@@ -209,7 +208,7 @@ class StateMachine : public ctf::lalr::StateMachine {
   void mark_conflict(std::size_t stateIndex, std::size_t itemIndex, LookaheadSet contributions) {
     auto& state = _states[stateIndex];
     auto& item = state.items()[itemIndex];
-    if (item.lookahead_sources().empty() || (contributions -= item.lookaheads()).none()) {
+    if (item.lookahead_sources().empty() || (contributions -= _pool[item.lookaheads()]).none()) {
       // all generated, nothing to mark
       return;
     }
@@ -276,7 +275,7 @@ class StateMachine : public ctf::lalr::StateMachine {
     }
     // cache lookahead contributions to states
     _contributionLookaheads.assign(_states.size(), {});
-    unordered_map<LookaheadSource, LookaheadSet> lookaheadMap;
+    unordered_map<LookaheadSource, id_type> lookaheadMap;
     for (std::size_t i = 0; i < _states.size(); ++i) {
       auto& contribution = _contributions[i];
       if (!contribution)
@@ -314,7 +313,7 @@ class StateMachine : public ctf::lalr::StateMachine {
   */
   InsertResult insert_state_lscelr(const vector_set<Item>& kernel) {
     std::size_t i = _states.size();
-    State newState(i, kernel, grammar(), _empty, _first);
+    State newState(i, kernel, grammar(), _empty, _first, _pool);
 
     auto& kernelStates = _kernelMap[kernel];
     // this is never empty
@@ -378,7 +377,7 @@ class StateMachine : public ctf::lalr::StateMachine {
       std::size_t other = isocores[i];
       auto& existing = _states[other];
       auto& lookahead = contributionLookaheads[i];
-      // lookaheads match in the conflicting states
+      // lookaheads match in the conflicting states, interned sets are compared by id
       if (lookahead == newLookaheads) {
         for (std::size_t i = 0; i < existing.items().size(); ++i) {
           auto& item = existing.items()[i];
@@ -398,10 +397,10 @@ class StateMachine : public ctf::lalr::StateMachine {
   \param[in] state The examined state.
   \param[in] masks Potential contributions for each item.
 
-  \returns The lookahead set masked with the contributions.
+  \returns The ids of the lookahead sets masked with the contributions.
   */
-  vector<LookaheadSet> lookaheads_lscelr(const State& state, const vector<LookaheadSet>& masks) {
-    unordered_map<LookaheadSource, LookaheadSet> lookaheadMap;
+  vector<id_type> lookaheads_lscelr(const State& state, const vector<LookaheadSet>& masks) {
+    unordered_map<LookaheadSource, id_type> lookaheadMap;
     return lookaheads_lscelr(state, masks, lookaheadMap);
   }
   /**
@@ -411,13 +410,12 @@ class StateMachine : public ctf::lalr::StateMachine {
   \param[in] masks Potential contributions for each item.
   \param[in,out] lookaheadMap A map containing the full lookahead sets for some sources.
 
-  \returns The lookahead set masked with the contributions.
+  \returns The ids of the lookahead sets masked with the contributions.
   */
-  vector<LookaheadSet> lookaheads_lscelr(
-    const State& state,
-    const vector<LookaheadSet>& masks,
-    unordered_map<LookaheadSource, LookaheadSet>& lookaheadMap) {
-    vector<LookaheadSet> result;
+  vector<id_type> lookaheads_lscelr(const State& state,
+                                    const vector<LookaheadSet>& masks,
+                                    unordered_map<LookaheadSource, id_type>& lookaheadMap) {
+    vector<id_type> result;
     LookaheadSet lookaheadMask(0);
 
     for (std::size_t i = 0; i < state.items().size(); ++i) {
@@ -427,22 +425,23 @@ class StateMachine : public ctf::lalr::StateMachine {
         continue;
       }
       lookaheadMask = mask;
-      result.push_back(item.lookaheads());
+      id_type lookaheads = item.lookaheads();
       for (auto& source : item.lookahead_sources()) {
-        unordered_map<LookaheadSource, LookaheadSet> tempMap(lookaheadMap);
         auto it = lookaheadMap.find(source);
         if (it == lookaheadMap.end()) {
-          // lookahead source not resolved
+          // lookahead source not resolved, partial results of cycles are not kept
+          unordered_map<LookaheadSource, id_type> tempMap(lookaheadMap);
           lookahead_lookup_lscelr(source, lookaheadMask, tempMap);
-          it = tempMap.find(source);
-          lookaheadMap.insert_or_assign(it->first, it->second);
+          it = lookaheadMap.insert_or_assign(source, tempMap[source]).first;
         }
-        result.back() |= it->second;
+        lookaheads = _pool.set_union(lookaheads, it->second);
         if (lookaheadMask.empty()) {
           break;
         }
       }
-      result.back() &= mask;
+      LookaheadSet masked(_pool[lookaheads]);
+      masked &= mask;
+      result.push_back(_pool.intern(std::move(masked)));
     }
 
     return result;
@@ -457,7 +456,7 @@ class StateMachine : public ctf::lalr::StateMachine {
   */
   void lookahead_lookup_lscelr(const LookaheadSource& source,
                                LookaheadSet& lookaheadMask,
-                               unordered_map<LookaheadSource, LookaheadSet>& lookaheadMap) {
+                               unordered_map<LookaheadSource, id_type>& lookaheadMap) {
     const auto& state = _states[source.state];
     // get all sources
     auto& item = state.items()[source.item];
@@ -465,12 +464,12 @@ class StateMachine : public ctf::lalr::StateMachine {
     // stop infinite loops
     lookaheadMap.insert_or_assign(source, item.lookaheads());
 
-    lookaheadMask -= item.lookaheads();
+    lookaheadMask -= _pool[item.lookaheads()];
     if (lookaheadMask.empty()) {
       return;
     }
 
-    LookaheadSet symbols(item.lookaheads());
+    id_type symbols = item.lookaheads();
     for (auto& nextSource : item.lookahead_sources()) {
       auto it = lookaheadMap.find(nextSource);
       if (it == lookaheadMap.end()) {
@@ -478,13 +477,13 @@ class StateMachine : public ctf::lalr::StateMachine {
         lookahead_lookup(nextSource, lookaheadMap);
         it = lookaheadMap.find(nextSource);
       }
-      symbols |= it->second;
+      symbols = _pool.set_union(symbols, it->second);
       if (lookaheadMask.empty()) {
-        lookaheadMap.insert_or_assign(source, std::move(symbols));
+        lookaheadMap.insert_or_assign(source, symbols);
         return;
       }
     }
-    lookaheadMap.insert_or_assign(source, std::move(symbols));
+    lookaheadMap.insert_or_assign(source, symbols);
   }
 };
 }  // namespace ctf::lscelr
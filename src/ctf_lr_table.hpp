@@ -7,6 +7,7 @@
 #define CRF_LR_TABLE_HPP
 
 #include <istream>
+#include <memory>
 
 #include "ctf_base.hpp"
 #include "ctf_lr_lalr.hpp"
@@ -25,14 +26,14 @@ enum class LRAction : unsigned char {
 class LRActionItem {
  public:
   constexpr LRActionItem(LRAction action, std::size_t argument = 0) noexcept
-    : _storage((argument & (std::numeric_limits<std::size_t>::max() >> 2)) |
-               (static_cast<std::size_t>(action) << (8 * sizeof(std::size_t) - 2))) {}
+    : _storage((static_cast<id_type>(argument) & (std::numeric_limits<id_type>::max() >> 2)) |
+               (static_cast<id_type>(action) << (8 * sizeof(id_type) - 2))) {}
 
   LRAction action() const noexcept {
-    return static_cast<LRAction>(_storage >> (sizeof(std::size_t) * 8 - 2));
+    return static_cast<LRAction>(_storage >> (sizeof(id_type) * 8 - 2));
   }
 
-  std::size_t argument() const noexcept { return (_storage << 2) >> 2; }
+  std::size_t argument() const noexcept { return static_cast<id_type>(_storage << 2) >> 2; }
 
   friend bool operator==(const LRActionItem& lhs, const LRActionItem& rhs) {
     return lhs._storage == rhs._storage;
@@ -41,7 +42,7 @@ class LRActionItem {
   friend bool operator!=(const LRActionItem& lhs, const LRActionItem& rhs) { return !(lhs == rhs); }
 
  protected:
-  std::size_t _storage;
+  id_type _storage;
 };
 
 class LRGenericTable {
@@ -53,8 +54,8 @@ class LRGenericTable {
   const LRActionItem& lr_action(std::size_t state, const Symbol& terminal) const {
     auto begin = _actionTable.begin() + _actionDelimiters[state];
     auto end = _actionTable.begin() + _actionDelimiters[state + 1];
-    auto it = std::lower_bound(begin, end, Record<LRActionItem>{terminal.id(), {LRAction::ERROR}});
-    if (it->key != terminal.id()) {
+    auto it = std::lower_bound(begin, end, terminal.id());
+    if (it == end || it->key != terminal.id()) {
       return _errorItem;
     }
     return it->value;
@@ -63,7 +64,7 @@ class LRGenericTable {
   std::size_t lr_goto(std::size_t state, const Symbol& nonterminal) const {
     auto begin = _gotoTable.begin() + _gotoDelimiters[state];
     auto end = _gotoTable.begin() + _gotoDelimiters[state + 1];
-    auto it = std::lower_bound(begin, end, Record<std::size_t>{nonterminal.id(), 0});
+    auto it = std::lower_bound(begin, end, nonterminal.id());
     // this should always find the correct key
     assert(it->key == nonterminal.id());
     return it->value;
@@ -71,6 +72,13 @@ class LRGenericTable {
 
   std::size_t states() const { return _states; }
 
+  /**
+  \brief Get the number of stored table entries.
+
+  \returns The number of action and goto records.
+  */
+  std::size_t size() const noexcept { return _actionTable.size() + _gotoTable.size(); }
+
   void save(std::ostream& os) const {
     os << _states << "\n";
     // save action table
@@ -111,19 +119,32 @@ class LRGenericTable {
  protected:
   template <typename T>
   struct Record {
-    std::size_t key;
+    id_type key;
     T value;
     friend bool operator<(const Record& lhs, const Record& rhs) { return lhs.key < rhs.key; }
+    friend bool operator<(const Record& lhs, std::size_t key) { return lhs.key < key; }
   };
   vector<Record<LRActionItem>> _actionTable;
-  vector<std::size_t> _actionDelimiters;
-  vector<Record<std::size_t>> _gotoTable;
-  vector<std::size_t> _gotoDelimiters;
+  vector<id_type> _actionDelimiters;
+  vector<Record<id_type>> _gotoTable;
+  vector<id_type> _gotoDelimiters;
 
   std::size_t _states = 1;
 
   LRActionItem _errorItem = LRActionItem(LRAction::ERROR);
 
+  /**
+  \brief Sets the number of states.
+
+  \param[in] states The number of states.
+
+  \throws std::invalid_argument When the states cannot be identified by id_type.
+  */
+  void set_states(std::size_t states) {
+    narrow_id(states, "The number of LR states");
+    _states = states;
+  }
+
   LRActionItem& insert_action(std::size_t state, const Symbol& terminal) {
     // there will always be at least one action per state
     while (_actionDelimiters.size() < state + 2) {
@@ -132,14 +153,16 @@ class LRGenericTable {
     assert(_actionDelimiters.size() == state + 2);
     auto begin = _actionTable.begin() + _actionDelimiters[state];
     auto end = _actionTable.begin() + _actionDelimiters[state + 1];
-    auto it = std::lower_bound(begin, end, Record<LRActionItem>{terminal.id(), {LRAction::ERROR}});
+    auto it = std::lower_bound(begin, end, terminal.id());
     // found record
     if (it != _actionTable.end() && it->key == terminal.id()) {
       return it->value;
     }
     // insert new record
+    narrow_id(_actionTable.size() + 1, "The number of LR actions");
     ++_actionDelimiters[state + 1];
-    return _actionTable.insert(it, {terminal.id(), LRActionItem(LRAction::ERROR)})->value;
+    Record<LRActionItem> record{static_cast<id_type>(terminal.id()), LRActionItem(LRAction::ERROR)};
+    return _actionTable.insert(it, record)->value;
   }
 
   void insert_goto(std::size_t state, const Symbol& nonterminal, std::size_t value) {
@@ -149,15 +172,17 @@ class LRGenericTable {
     assert(_gotoDelimiters.size() == state + 2);
     auto begin = _gotoTable.begin() + _gotoDelimiters[state];
     auto end = _gotoTable.begin() + _gotoDelimiters[state + 1];
-    auto it = std::lower_bound(begin, end, Record<std::size_t>{nonterminal.id(), 0});
+    auto it = std::lower_bound(begin, end, nonterminal.id());
     // found record
     if (it != _gotoTable.end() && it->key == nonterminal.id()) {
-      it->value = value;
+      it->value = static_cast<id_type>(value);
       return;
     }
     // insert new record
+    narrow_id(_gotoTable.size() + 1, "The number of LR gotos");
     ++_gotoDelimiters[state + 1];
-    _gotoTable.insert(it, {nonterminal.id(), value});
+    Record<id_type> record{static_cast<id_type>(nonterminal.id()), static_cast<id_type>(value)};
+    _gotoTable.insert(it, record);
   }
 
   void initialize_tables() {
@@ -179,7 +204,7 @@ class LR1GenericTable : public LRGenericTable {
   LR1GenericTable() {}
   LR1GenericTable(const TranslationGrammar& grammar, symbol_string_fn to_str = ctf::to_string) {
     StateMachine sm(grammar);
-    _states = sm.states().size();
+    set_states(sm.states().size());
 
     for (auto& state : sm.states()) {
       for (auto& item : state.items()) {
@@ -188,7 +213,19 @@ class LR1GenericTable : public LRGenericTable {
     }
   }
 
+  /**
+  \brief Get the number of conflicts not resolved by precedence.
+
+  \returns The number of R/R conflicts resolved by selecting the rule defined first.
+  */
+  std::size_t unresolved_conflicts() const noexcept { return _unresolvedConflicts; }
+
  protected:
+  /**
+  \brief The number of R/R conflicts encountered during the table's construction.
+  */
+  std::size_t _unresolvedConflicts = 0;
+
   void lr1_insert(const typename StateMachine::State& state,
                   const typename StateMachine::Item& item,
                   const unordered_map<Symbol, std::size_t>& transitionMap,
@@ -203,7 +240,7 @@ class LR1GenericTable : public LRGenericTable {
     if (rule == grammar.starting_rule() && mark == 1) {
       insert_action(id, Symbol::eof()) = {LRAction::SUCCESS};
     } else if (mark == rule.input().size()) {
-      for (auto& terminal : item.lookaheads().symbols()) {
+      for (auto& terminal : state.lookahead_set(item).symbols()) {
         auto& action = insert_action(id, terminal);
         if (action.action() != LRAction::ERROR) {
           action = conflict_resolution(
@@ -248,6 +285,9 @@ class LR1GenericTable : public LRGenericTable {
     using namespace std::literals;
     // R/R conflict: select rule defined first in the grammar
     if (item.action() == LRAction::REDUCE) {
+      if (reduceItem != item) {
+        ++_unresolvedConflicts;
+      }
       return (reduceItem.argument() <= item.argument()) ? reduceItem : item;
     }
     // S/R conflict:
@@ -283,7 +323,7 @@ class LR1StrictGenericTable : public LRGenericTable {
   LR1StrictGenericTable(const TranslationGrammar& grammar,
                         symbol_string_fn to_str = ctf::to_string) {
     StateMachine sm(grammar);
-    _states = sm.states().size();
+    set_states(sm.states().size());
 
     for (auto& state : sm.states()) {
       for (auto& item : state.items()) {
@@ -305,7 +345,7 @@ class LR1StrictGenericTable : public LRGenericTable {
     if (rule == grammar.starting_rule() && mark == 1) {
       insert_action(state.id(), Symbol::eof()) = {LRAction::SUCCESS};
     } else if (mark == rule.input().size()) {
-      for (auto& terminal : item.lookaheads().symbols()) {
+      for (auto& terminal : state.lookahead_set(item).symbols()) {
         auto& action = insert_action(state.id(), terminal);
         if (action.action() != LRAction::ERROR) {
           throw std::invalid_argument(
@@ -345,29 +385,213 @@ class LR1StrictGenericTable : public LRGenericTable {
   }
 };
 
+/**
+\brief LR table for generalized LR parsing. Conflicts not resolved by precedence are kept.
+
+S/R conflicts are resolved by precedence and associativity like in LR1GenericTable; a conflict
+between a terminal and a rule with equal declared precedence and no associativity removes both
+actions. All other conflicting actions are kept. lr_action() returns the primary action of a cell,
+which is the shift or the reduction by the rule defined first; lr_conflicts() returns the other
+actions of the cell. Saving the table only saves the primary actions.
+*/
+template <typename StateMachine>
+class GLRGenericTable : public LRGenericTable {
+ public:
+  /**
+  \brief A range of conflicting actions.
+  */
+  struct ActionRange {
+    const LRActionItem* first;
+    const LRActionItem* last;
+
+    const LRActionItem* begin() const noexcept { return first; }
+    const LRActionItem* end() const noexcept { return last; }
+    bool empty() const noexcept { return first == last; }
+    std::size_t size() const noexcept { return static_cast<std::size_t>(last - first); }
+  };
+
+  GLRGenericTable() {}
+  GLRGenericTable(const TranslationGrammar& grammar, symbol_string_fn = ctf::to_string) {
+    StateMachine sm(grammar);
+    set_states(sm.states().size());
+
+    for (auto& state : sm.states()) {
+      // cells are collected in terminal order and inserted after all items are processed
+      map<std::size_t, pair<Symbol, vector<LRActionItem>>> cells;
+      auto cell = [&cells](const Symbol& terminal) -> vector<LRActionItem>& {
+        return cells.try_emplace(terminal.id(), terminal, vector<LRActionItem>{})
+          .first->second.second;
+      };
+      for (auto& item : state.items()) {
+        auto& rule = item.rule();
+        std::size_t mark = item.mark();
+        if (rule == grammar.starting_rule() && mark == 1) {
+          cell(Symbol::eof()).push_back({LRAction::SUCCESS});
+        } else if (mark == rule.input().size()) {
+          for (auto& terminal : state.lookahead_set(item).symbols()) {
+            cell(terminal).push_back({LRAction::REDUCE, rule.id});
+          }
+        } else if (rule.input()[mark].nonterminal()) {
+          auto& nonterminal = rule.input()[mark];
+          insert_goto(state.id(), nonterminal, state.transitions().at(nonterminal));
+        } else {
+          auto& terminal = rule.input()[mark];
+          cell(terminal).push_back({LRAction::SHIFT, state.transitions().at(terminal)});
+        }
+      }
+      for (auto& [id, entry] : cells) {
+        insert_cell(state.id(), entry.first, entry.second, grammar);
+      }
+      while (_conflictDelimiters.size() < state.id() + 2) {
+        _conflictDelimiters.push_back(static_cast<id_type>(_conflictCells.size()));
+      }
+    }
+    // the end of the last cell's actions
+    _conflictCells.push_back({0, narrow_id(_conflictActions.size(), "The number of LR conflicts")});
+    narrow_id(_conflictCells.size(), "The number of LR conflict cells");
+  }
+
+  /**
+  \brief Get the actions of a cell other than the primary action.
+
+  \param[in] state The state.
+  \param[in] terminal The lookahead terminal.
+
+  \returns The conflicting actions. Empty if the cell has no conflicts.
+  */
+  ActionRange lr_conflicts(std::size_t state, const Symbol& terminal) const noexcept {
+    if (!conflicted(state)) {
+      return {nullptr, nullptr};
+    }
+    auto begin = _conflictCells.begin() + _conflictDelimiters[state];
+    auto end = _conflictCells.begin() + _conflictDelimiters[state + 1];
+    auto it = std::lower_bound(begin, end, terminal.id());
+    if (it == end || it->key != terminal.id()) {
+      return {nullptr, nullptr};
+    }
+    const LRActionItem* actions = _conflictActions.data();
+    return {actions + it->value, actions + (it + 1)->value};
+  }
+
+  /**
+  \brief Check whether a state has any conflicting cells.
+  */
+  bool conflicted(std::size_t state) const noexcept {
+    return state + 1 < _conflictDelimiters.size() &&
+           _conflictDelimiters[state] != _conflictDelimiters[state + 1];
+  }
+
+  /**
+  \brief Get the number of cells with conflicting actions.
+  */
+  std::size_t unresolved_conflicts() const noexcept {
+    return _conflictCells.empty() ? 0 : _conflictCells.size() - 1;
+  }
+
+ protected:
+  /**
+  \brief Conflicting cells of each state sorted by terminal. The value is the offset of the
+  cell's first action in _conflictActions. The last record only marks the end of the actions.
+  */
+  vector<Record<id_type>> _conflictCells;
+  vector<id_type> _conflictDelimiters{0};
+  vector<LRActionItem> _conflictActions;
+
+  void insert_cell(std::size_t state,
+                   const Symbol& terminal,
+                   vector<LRActionItem>& actions,
+                   const TranslationGrammar& grammar) {
+    // the shift or success goes first, followed by reductions in rule order; all items shifting
+    // the same terminal share the target state
+    std::sort(actions.begin(), actions.end(), [](const LRActionItem& lhs, const LRActionItem& rhs) {
+      bool lhsReduce = lhs.action() == LRAction::REDUCE;
+      bool rhsReduce = rhs.action() == LRAction::REDUCE;
+      return lhsReduce != rhsReduce ? rhsReduce : lhs.argument() < rhs.argument();
+    });
+    actions.erase(std::unique(actions.begin(), actions.end()), actions.end());
+    assert(std::count_if(actions.begin(), actions.end(), [](const LRActionItem& action) {
+             return action.action() != LRAction::REDUCE;
+           }) <= 1);
+    if (actions.front().action() == LRAction::SHIFT) {
+      resolve_precedence(terminal, actions, grammar);
+    }
+    if (actions.empty()) {
+      return;
+    }
+    insert_action(state, terminal) = actions.front();
+    if (actions.size() == 1) {
+      return;
+    }
+    while (_conflictDelimiters.size() < state + 1) {
+      _conflictDelimiters.push_back(static_cast<id_type>(_conflictCells.size()));
+    }
+    _conflictCells.push_back(
+      {static_cast<id_type>(terminal.id()), static_cast<id_type>(_conflictActions.size())});
+    _conflictActions.insert(_conflictActions.end(), actions.begin() + 1, actions.end());
+  }
+
+  /**
+  \brief Resolves S/R conflicts of a cell by precedence. The shift is the first action.
+  */
+  void resolve_precedence(const Symbol& terminal,
+                          vector<LRActionItem>& actions,
+                          const TranslationGrammar& grammar) {
+    auto [associativity, precedence] = grammar.precedence(terminal);
+    bool keepShift = true;
+    vector<LRActionItem> kept;
+    for (auto it = actions.begin() + 1; it != actions.end(); ++it) {
+      auto& rule = grammar.rules()[it->argument()];
+      auto precedence2 = std::get<1>(grammar.precedence(rule.precedence_symbol()));
+      if (precedence < precedence2 ||
+          (precedence == precedence2 && associativity == Associativity::RIGHT)) {
+        // shift preferred
+        continue;
+      }
+      if (precedence == precedence2 && associativity == Associativity::NONE) {
+        if (precedence == std::numeric_limits<std::size_t>::max()) {
+          // no declared precedence, the conflict is kept
+          kept.push_back(*it);
+        } else {
+          keepShift = false;
+        }
+        continue;
+      }
+      // reduce preferred
+      keepShift = false;
+      kept.push_back(*it);
+    }
+    if (keepShift) {
+      kept.insert(kept.begin(), actions.front());
+    }
+    actions = std::move(kept);
+  }
+};
+
 class LRSavedTable : public LRGenericTable {
  public:
   // ignore inicialization
   LRSavedTable() {}
   LRSavedTable(const TranslationGrammar&, symbol_string_fn = ctf::to_string) {}
   LRSavedTable(std::istream& is) {
-    is >> _states;
-    if (_states < 1) {
+    std::size_t states = 0;
+    is >> states;
+    if (states < 1) {
       throw std::invalid_argument("Invalid saved parsing table.");
     }
+    set_states(states);
     // skip \n
     is.get();
-    _actionDelimiters.pop_back();
+    _actionDelimiters.clear();
     // initialize action table
     for (std::size_t i = 0; i < _states; ++i) {
-      _actionDelimiters.push_back(_actionTable.size());
+      _actionDelimiters.push_back(narrow_id(_actionTable.size(), "The number of LR actions"));
       while (true) {
         char c = is.get();
         if (c == '\n') {
           break;
         }
 
-        std::size_t terminal = 0;
+        id_type terminal = 0;
         is >> terminal;
         // skip :
         is.get();
@@ -385,24 +609,26 @@ class LRSavedTable : public LRGenericTable {
         }
       }
     }
+    _actionDelimiters.push_back(narrow_id(_actionTable.size(), "The number of LR actions"));
     // initialize goto table
-    _gotoDelimiters.pop_back();
+    _gotoDelimiters.clear();
     for (std::size_t i = 0; i < _states; ++i) {
-      _gotoDelimiters.push_back(_gotoTable.size());
+      _gotoDelimiters.push_back(narrow_id(_gotoTable.size(), "The number of LR gotos"));
       while (true) {
         char c = is.get();
         if (c == '\n') {
           break;
         }
-        std::size_t nonterminal = 0;
+        id_type nonterminal = 0;
         is >> nonterminal;
         // skip :
         is.get();
-        std::size_t argument = 0;
+        id_type argument = 0;
         is >> argument;
         _gotoTable.push_back({nonterminal, argument});
       }
     }
+    _gotoDelimiters.push_back(narrow_id(_gotoTable.size(), "The number of LR gotos"));
   }
 };
 
@@ -413,6 +639,143 @@ using LSCELRTable = LR1GenericTable<lscelr::StateMachine>;
 using LR1StrictTable = LR1StrictGenericTable<lr1::StateMachine>;
 using LALRStrictTable = LR1StrictGenericTable<lalr::StateMachine>;
 
+using LALRGLRTable = GLRGenericTable<lalr::StateMachine>;
+using LR1GLRTable = GLRGenericTable<lr1::StateMachine>;
+
+/**
+\brief The table construction algorithms selectable by LRAutoTable.
+*/
+enum class LRAlgorithm {
+  LALR,
+  LSCELR,
+  LR1,
+};
+
+inline const char* to_string(LRAlgorithm algorithm) {
+  switch (algorithm) {
+    case LRAlgorithm::LALR:
+      return "LALR";
+    case LRAlgorithm::LSCELR:
+      return "LSCELR";
+    case LRAlgorithm::LR1:
+      return "LR1";
+  }
+  return "";
+}
+
+/**
+\brief LR table constructed by the cheapest algorithm that handles the grammar.
+
+LALR is tried first. LSCELR and then canonical LR(1) are only constructed when the previous
+automaton has conflicts that precedences do not resolve.
+*/
+class LRAutoTable : public LRGenericTable {
+ public:
+  LRAutoTable() {}
+  LRAutoTable(const TranslationGrammar& grammar, symbol_string_fn to_str = ctf::to_string) {
+    if (try_table<LALRTable>(grammar, to_str, LRAlgorithm::LALR)) {
+      return;
+    }
+    if (try_table<LSCELRTable>(grammar, to_str, LRAlgorithm::LSCELR)) {
+      return;
+    }
+    // canonical LR(1) conflicts are inherent to the grammar
+    LR1Table table(grammar, to_str);
+    _unresolvedConflicts = table.unresolved_conflicts();
+    LRGenericTable::operator=(std::move(table));
+    _algorithm = LRAlgorithm::LR1;
+  }
+
+  /**
+  \brief Get the algorithm that constructed this table.
+  */
+  LRAlgorithm algorithm() const noexcept { return _algorithm; }
+
+  /**
+  \brief Get the number of conflicts not resolved by precedence.
+  */
+  std::size_t unresolved_conflicts() const noexcept { return _unresolvedConflicts; }
+
+ protected:
+  LRAlgorithm _algorithm = LRAlgorithm::LALR;
+  std::size_t _unresolvedConflicts = 0;
+
+  /**
+  \brief Constructs a table and keeps it if it has no unresolved conflicts.
+
+  \returns True if the table was kept.
+  */
+  template <typename Table>
+  bool try_table(const TranslationGrammar& grammar,
+                 symbol_string_fn to_str,
+                 LRAlgorithm algorithm) {
+    try {
+      Table table(grammar, to_str);
+      if (table.unresolved_conflicts() != 0) {
+        return false;
+      }
+      LRGenericTable::operator=(std::move(table));
+      _algorithm = algorithm;
+      return true;
+    } catch (std::invalid_argument&) {
+      // S/R conflict without associativity, may not be present in a stronger automaton
+      return false;
+    }
+  }
+};
+
+/**
+\brief A read-only LR table shared by multiple translation controls.
+
+Copying the table only copies a reference to the shared table data.
+*/
+class LRSharedTable {
+ public:
+  LRSharedTable() = default;
+  /**
+  \brief Constructs a new shared table with the automatically selected algorithm.
+
+  \param[in] grammar The translation grammar.
+  \param[in] to_str The symbol printing function.
+  */
+  LRSharedTable(const TranslationGrammar& grammar, symbol_string_fn to_str = ctf::to_string)
+    : _table(std::make_shared<const LRGenericTable>(LRAutoTable(grammar, to_str))) {}
+  /**
+  \brief Constructs the table from existing shared table data.
+
+  \param[in] table The shared table.
+  */
+  explicit LRSharedTable(std::shared_ptr<const LRGenericTable> table) noexcept
+    : _table(std::move(table)) {}
+
+  const LRActionItem& lr_action(std::size_t state, const Symbol& terminal) const {
+    return _table->lr_action(state, terminal);
+  }
+
+  std::size_t lr_goto(std::size_t state, const Symbol& nonterminal) const {
+    return _table->lr_goto(state, nonterminal);
+  }
+
+  std::size_t states() const { return _table->states(); }
+
+  std::size_t size() const noexcept { return _table->size(); }
+
+  void save(std::ostream& os) const { _table->save(os); }
+
+  /**
+  \brief Get the shared table data.
+  */
+  const std::shared_ptr<const LRGenericTable>& shared() const noexcept { return _table; }
+
+  /**
+  \brief Implicit conversion to the shared table data, used by error message functions.
+  */
+  operator const LRGenericTable&() const noexcept { return *_table; }
+
+ private:
+  std::shared_ptr<const LRGenericTable> _table;
+};
+
 }  // namespace ctf
 #endif
 
@@ -8,6 +8,7 @@
 
 #include <functional>
 #include <iostream>
+#include <memory>
 
 #include "ctf_lr_lalr.hpp"
 #include "ctf_lr_lr0.hpp"
@@ -65,31 +66,29 @@ class LRTranslationControlGeneral : public TranslationControl {
 
  protected:
   /**
-  \brief Creates iterator attribute actions for incoming terminals.
+  \brief Creates iterator attribute actions for incoming terminals from a precompiled attribute
+  plan.
 
-  \param[in] obegin Iterator to the first Symbol of the output of the applied
-  Rule.
-  \param[in] targets Indices of the target actions for all input terminals.
-  \param[in] outputSize The size of the output for target generation.
+  \param[in] olast Iterator to the last Symbol of the output of the applied Rule.
+  \param[in] plan The attribute plan of the applied Rule.
   \param[out] attributeActions Targets to append incoming terminal's attributes.
-
-  The added iterators point to input terminal attribute targets.
   */
-  void create_attibute_actions(tstack<Token>::iterator obegin,
-                               const vector<vector_set<std::size_t>>& targets,
-                               std::size_t outputSize,
-                               tstack<vector<tstack<Token>::iterator>>& attributeActions) {
-    for (auto& target : targets) {
+  void create_attribute_actions(tstack<Token>::iterator olast,
+                                const id_type* plan,
+                                tstack<vector<tstack<Token>::iterator>>& attributeActions) {
+    for (id_type terminals = *plan++; terminals > 0; --terminals) {
       vector<tstack<Token>::iterator> iterators;
-      for (auto& i : target) {
-        auto oit = obegin;
-        for (std::size_t x = 0; x < outputSize - i - 1; ++x) {
+      id_type targets = *plan++;
+      iterators.reserve(targets);
+      auto oit = olast;
+      std::size_t distance = 0;
+      for (; targets > 0; --targets) {
+        for (std::size_t target = *plan++; distance < target; ++distance) {
           --oit;
         }
-        if (oit->type() == Symbol::Type::TERMINAL || oit->type() == Symbol::Type::EOI)
-          iterators.push_back(oit);
+        iterators.push_back(oit);
       }
-      attributeActions.push(iterators);
+      attributeActions.push(std::move(iterators));
     }
   }
 
@@ -97,6 +96,10 @@ class LRTranslationControlGeneral : public TranslationControl {
 
   void add_error(const Token& token, const string& message) {
     set_error();
+    if (_diagnostics) {
+      _diagnostics->error(token.location(), message);
+      return;
+    }
     err() << token.location().to_string() << ": " << output::color::red << "ERROR" << output::reset
           << ":\n"
           << message << "\n";
@@ -105,7 +108,7 @@ class LRTranslationControlGeneral : public TranslationControl {
   /**
   \brief Placeholder error recovery.
   */
-  virtual bool error_recovery(vector<std::size_t>&, Token&) { return false; }
+  virtual bool error_recovery(vector<id_type>&, Token&) { return false; }
 };  // namespace ctf
 
 /**
@@ -135,7 +138,8 @@ class LRTranslationControlTemplate : public LRTranslationControlGeneral {
   */
   LRTranslationControlTemplate(LexicalAnalyzer& la,
                                TranslationGrammar& tg,
-                               symbol_string_fn to_str = ctf::to_string) {
+                               symbol_string_fn to_str = ctf::to_string)
+    : _errorMessage(default_lr_error_message) {
     set_grammar(tg, to_str);
     set_lexical_analyzer(la);
   }
@@ -143,7 +147,7 @@ class LRTranslationControlTemplate : public LRTranslationControlGeneral {
   /**
   \brief Runs the translation. Output symbols are stored in _output.
   */
-  void run(const InputReader& reader, symbol_string_fn to_str = ctf::to_string) final {
+  void run(const InputReader& reader, symbol_string_fn to_str = ctf::to_string) override {
     if (!_lexicalAnalyzer)
       throw TranslationException("No lexical analyzer was attached.");
     else if (!_translationGrammar)
@@ -153,33 +157,31 @@ class LRTranslationControlTemplate : public LRTranslationControlGeneral {
     _output.clear();
 
     std::size_t state = 0;
-    vector<std::size_t> pushdown;
-    vector<std::size_t> appliedRules{};
+    vector<id_type> pushdown;
+    vector<id_type> appliedRules{};
 
-    pushdown.push_back(state);
+    pushdown.push_back(static_cast<id_type>(state));
 
-    Token token = next_token();
+    Token token = next_token(state);
 
     while (true) {
       switch (auto& item = _lrTable.lr_action(state, token.symbol()); item.action()) {
         case LRAction::SHIFT:
           state = item.argument();
-          pushdown.push_back(state);
-          token = next_token();
+          pushdown.push_back(static_cast<id_type>(state));
+          token = next_token(state);
           break;
         case LRAction::REDUCE: {
-          auto& rule = _translationGrammar->rules()[item.argument()];
-          for (std::size_t i = 0; i < rule.input().size(); ++i) {
-            pushdown.pop_back();
-          }
+          auto& rule = (*_packedRules)[item.argument()];
+          pushdown.resize(pushdown.size() - rule.inputSize);
           const auto& stackState = pushdown.back();
-          state = _lrTable.lr_goto(stackState, rule.nonterminal());
-          pushdown.push_back(state);
-          appliedRules.push_back(item.argument());
+          state = _lrTable.lr_goto(stackState, rule.nonterminal);
+          pushdown.push_back(static_cast<id_type>(state));
+          appliedRules.push_back(static_cast<id_type>(item.argument()));
           break;
         }
         case LRAction::SUCCESS:
-          appliedRules.push_back(_translationGrammar->rules().size() - 1);
+          appliedRules.push_back(static_cast<id_type>(_packedRules->size() - 1));
           produce_output(appliedRules);
           return;
         case LRAction::ERROR:
@@ -195,7 +197,7 @@ class LRTranslationControlTemplate : public LRTranslationControlGeneral {
   /**
    * Iterates over reversed rules and applies them in a top-down manner.
    */
-  void produce_output(const vector<std::size_t>& appliedRules) {
+  void produce_output(const vector<id_type>& appliedRules) {
     tstack<vector<tstack<Token>::iterator>> attributeActions;
 
     _input.push(_translationGrammar->starting_symbol());
@@ -203,11 +205,12 @@ class LRTranslationControlTemplate : public LRTranslationControlGeneral {
 
     auto obegin = _output.begin();
     auto tokenIt = _tokens.crbegin();
+    const auto& rules = *_packedRules;
     for (auto& ruleIndex : reverse(appliedRules)) {
-      auto& rule = _translationGrammar->rules()[ruleIndex];
-      _input.replace_last(rule.nonterminal(), rule.input());
-      obegin = --(_output.replace_last(rule.nonterminal(), rule.output(), obegin));
-      create_attibute_actions(obegin, rule.actions(), rule.output().size(), attributeActions);
+      auto& rule = rules[ruleIndex];
+      _input.replace_last(rule.nonterminal, rules.input(rule));
+      obegin = --(_output.replace_last(rule.nonterminal, rules.output(rule), obegin));
+      create_attribute_actions(obegin, rules.plan(rule), attributeActions);
       // apply attribute actions for all current rightmost terminals
       for (auto workingTerminalIt = _input.crbegin();
            workingTerminalIt != _input.crend() &&
@@ -233,18 +236,28 @@ class LRTranslationControlTemplate : public LRTranslationControlGeneral {
                    symbol_string_fn to_str = ctf::to_string) override {
     _translationGrammar = &tg;
     create_lr_table(to_str);
+    _packedRules = std::make_shared<const PackedRules>(tg);
   }
 
-  bool error_recovery(vector<std::size_t>&, Token&) override { return false; }
+  bool error_recovery(vector<id_type>&, Token&) override { return false; }
 
   void save(std::ostream& os) const override { _lrTable.save(os); }
 
+  /**
+  \brief Get the LR table used to control the translation.
+  */
+  const LRTableType& lr_table() const noexcept { return _lrTable; }
+
  protected:
   /**
   \brief LR table used to control the translation.
   */
   LRTableType _lrTable;
   /**
+  \brief The rules of the translation grammar, read on every reduction.
+  */
+  std::shared_ptr<const PackedRules> _packedRules;
+  /**
   \brief All read tokens
   */
   vector<Token> _tokens;
@@ -262,6 +275,17 @@ class LRTranslationControlTemplate : public LRTranslationControlGeneral {
     _tokens.push_back(TranslationControl::next_token());
     return _tokens.back();
   }
+
+  /**
+  \brief Returns the next token when the parser is in a state. Subclasses may override this to
+  let the state select the tokens that are read.
+
+  \param[in] state The state on top of the pushdown.
+  */
+  virtual Token next_token(std::size_t state) {
+    (void)state;
+    return next_token();
+  }
 };
 
 class SavedLRTranslationControl : public LRTranslationControlTemplate<LRSavedTable> {
@@ -274,12 +298,14 @@ class SavedLRTranslationControl : public LRTranslationControlTemplate<LRSavedTab
  protected:
   void set_grammar(const TranslationGrammar& tg, symbol_string_fn = ctf::to_string) override {
     _translationGrammar = &tg;
+    _packedRules = std::make_shared<const PackedRules>(tg);
   }
 };
 
 using LALRTranslationControl = LRTranslationControlTemplate<LALRTable>;
 using LR1TranslationControl = LRTranslationControlTemplate<LR1Table>;
 using LSCELRTranslationControl = LRTranslationControlTemplate<LSCELRTable>;
+using AutoTranslationControl = LRTranslationControlTemplate<LRAutoTable>;
 
 using LALRStrictTranslationControl = LRTranslationControlTemplate<LALRStrictTable>;
 using LR1StrictTranslationControl = LRTranslationControlTemplate<LR1StrictTable>;
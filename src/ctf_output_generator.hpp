@@ -10,6 +10,7 @@ and outputs it into a stream.
 #include <ostream>
 
 #include "ctf_base.hpp"
+#include "ctf_diagnostics.hpp"
 #include "ctf_output_utilities.hpp"
 
 namespace ctf {
@@ -58,6 +59,17 @@ class OutputGenerator {
   */
   void set_error_stream(std::ostream& o) noexcept { _error = &o; }
   /**
+  \brief Sets the diagnostic sink. Warnings and errors are recorded in the sink instead of being
+  written to the error stream.
+
+  \param[in] sink The diagnostic sink.
+  */
+  void set_diagnostics(DiagnosticSink& sink) noexcept { _diagnostics = &sink; }
+  /**
+  \brief Removes the diagnostic sink. Warnings and errors are written to the error stream.
+  */
+  void remove_diagnostics() noexcept { _diagnostics = nullptr; }
+  /**
   \brief Get the error flag.
 
   \returns True when an error has been encountered.
@@ -130,7 +142,18 @@ class OutputGenerator {
     return *_error;
   }
 
+  /**
+  \brief Get the diagnostic sink.
+
+  \returns A pointer to the diagnostic sink or nullptr if none is set.
+  */
+  DiagnosticSink* diagnostics() const noexcept { return _diagnostics; }
+
   void warning(const string& message) {
+    if (_diagnostics) {
+      _diagnostics->warning(message);
+      return;
+    }
     err() << output::color::yellow << "warning" << output::reset << ":\n" << message << "\n";
   }
   /**
@@ -138,24 +161,36 @@ class OutputGenerator {
   it.
   */
   void warning(const tstack<Token>::const_iterator it, const string& message) {
+    if (_diagnostics) {
+      _diagnostics->warning(it->location(), message);
+      return;
+    }
     err() << it->location().to_string() << ": " << output::color::yellow << "warning"
           << output::reset << ":\n"
           << message << "\n";
   }
 
   void error(const string& message) {
-    err() << output::color::red << "ERROR" << output::reset << ":\n" << message << "\n";
     set_error();
+    if (_diagnostics) {
+      _diagnostics->error(message);
+      return;
+    }
+    err() << output::color::red << "ERROR" << output::reset << ":\n" << message << "\n";
   }
   /**
   \brief Outputs an error message with the location automatically printed before
   it.
   */
   void error(const tstack<Token>::const_iterator it, const string& message) {
+    set_error();
+    if (_diagnostics) {
+      _diagnostics->error(it->location(), message);
+      return;
+    }
     err() << it->location().to_string() << ": " << output::color::red << "ERROR" << output::reset
           << ":\n"
           << message << "\n";
-    set_error();
   }
 
   [[noreturn]] void fatal_error(const string& message) {
@@ -183,6 +218,11 @@ class OutputGenerator {
   \brief The error stream.
   */
   std::ostream* _error;
+
+  /**
+  \brief The diagnostic sink. Messages are written to the error stream if not set.
+  */
+  DiagnosticSink* _diagnostics = nullptr;
 };
 }  // namespace ctf
 
@@ -0,0 +1,255 @@
+/**
+\file ctf_scannerless_translation_control.hpp
+\brief Defines class ScannerlessLexicalAnalyzer, which only matches the terminals valid in the
+current parser state, and class ScannerlessTranslationControlTemplate, which selects them.
+\author Radek Vít
+*/
+#ifndef CTF_SCANNERLESS_TRANSLATION_CONTROL_H
+#define CTF_SCANNERLESS_TRANSLATION_CONTROL_H
+
+#include <memory>
+#include <string_view>
+
+#include "ctf_dfa_lexical_analyzer.hpp"
+#include "ctf_lr_translation_control.hpp"
+
+namespace ctf {
+
+/**
+\brief Lexical analyzer defined by TokenPatterns that only matches the terminals valid in a
+context.
+
+A context is a set of terminals. Its automaton is compiled from the patterns of its terminals and
+all SKIP patterns when the context is first requested and is shared by all equal sets. Within a
+context, a pattern of a terminal that is not valid never matches, so a keyword is lexed as an
+identifier wherever only identifiers are valid. If no pattern of the context matches, all
+terminals are tried, so that the parser reports a syntax error instead of a lexical error.
+
+Each token's attribute is a std::string_view of its lexeme, unless attribute() is overridden. The
+view points into the buffer of the reader and is valid until its stream is replaced or the reader
+is destroyed.
+*/
+class ScannerlessLexicalAnalyzer : public LexicalAnalyzer {
+ public:
+  /**
+  \brief The context matching all terminals. Used until a context is set.
+  */
+  static constexpr id_type all_terminals = 0;
+
+  /**
+  \brief Constructs the lexical analyzer.
+
+  \param[in] patterns The patterns of terminals and skipped lexemes. When several patterns match
+  the longest lexeme, the first one is selected.
+  */
+  explicit ScannerlessLexicalAnalyzer(vector<TokenPattern> patterns)
+    : _patterns(std::move(patterns)) {
+    _automata.push_back(std::make_unique<LexerDFA>(LexerDFA::compile(_patterns)));
+  }
+
+  /**
+  \brief Get the context matching a set of terminals. Constructs its automaton on first use.
+
+  \param[in] valid Flags indexed by Symbol::id(). The patterns of terminals with a set flag are
+  matched.
+
+  \returns The context.
+  */
+  id_type context(const vector<bool>& valid) {
+    auto [it, inserted] = _contexts.try_emplace(valid, static_cast<id_type>(_automata.size()));
+    if (inserted) {
+      vector<TokenPattern> selected;
+      for (auto& pattern : _patterns) {
+        if (pattern.kind == LexemeKind::SKIP ||
+            (pattern.terminal.id() < valid.size() && valid[pattern.terminal.id()])) {
+          selected.push_back(pattern);
+        }
+      }
+      _automata.push_back(std::make_unique<LexerDFA>(LexerDFA::compile(selected)));
+    }
+    return it->second;
+  }
+
+  /**
+  \brief Sets the context of the next token.
+
+  \param[in] context The context returned by context() or all_terminals.
+  */
+  void set_context(id_type context) noexcept { _context = context; }
+
+  /**
+  \brief Get the number of constructed contexts, including all_terminals.
+  */
+  std::size_t contexts() const noexcept { return _automata.size(); }
+
+ protected:
+  /**
+  \brief Returns the next token matched in the current context.
+
+  \returns The next token.
+  */
+  Token read_token() override {
+    if (!_read) {
+      _input = reader()->read_all();
+      _read = true;
+      _cursor = Location{reader()->stream_name()};
+    }
+    while (_position < _input.size()) {
+      Lexeme lexeme = _automata[_context]->match(_input, _position);
+      if (lexeme.kind == LexemeKind::ERROR && _context != all_terminals) {
+        lexeme = _automata[all_terminals]->match(_input, _position);
+      }
+      _position = lexeme.end;
+      if (lexeme.kind == LexemeKind::SKIP) {
+        continue;
+      }
+      set_location(advance(lexeme.begin));
+      auto text = _input.substr(lexeme.begin, lexeme.end - lexeme.begin);
+      if (lexeme.kind == LexemeKind::ERROR) {
+        fatal_error("Unexpected character '" + string(text) + "'.");
+      }
+      return token(lexeme.symbol, attribute(lexeme.symbol, text));
+    }
+    set_location(advance(_input.size()));
+    return token_eof();
+  }
+
+  /**
+  \brief Constructs the attribute of a token.
+
+  \param[in] terminal The terminal of the token.
+  \param[in] text The lexeme.
+
+  \returns The attribute of the token. The default implementation returns the view of the lexeme.
+  */
+  virtual Attribute attribute(Symbol terminal, std::string_view text) {
+    (void)terminal;
+    return Attribute(text);
+  }
+
+  /**
+  \brief Discards the read input. Subclasses overriding this method must call it.
+  */
+  void reset_private() override {
+    _read = false;
+    _input = {};
+    _position = 0;
+    _offset = 0;
+    _context = all_terminals;
+  }
+
+ private:
+  vector<TokenPattern> _patterns;
+  /**
+  \brief The automaton of each context.
+  */
+  vector<std::unique_ptr<LexerDFA>> _automata;
+  map<vector<bool>, id_type> _contexts;
+  id_type _context = all_terminals;
+
+  bool _read = false;
+  /**
+  \brief The input. Points into the buffer of the reader.
+  */
+  std::string_view _input;
+  /**
+  \brief The offset of the next lexeme.
+  */
+  std::size_t _position = 0;
+  /**
+  \brief The location of the character at _offset. Token locations are computed incrementally.
+  */
+  Location _cursor;
+  std::size_t _offset = 0;
+
+  const Location& advance(std::size_t offset) {
+    for (; _offset < offset; ++_offset) {
+      if (_input[_offset] == '\n') {
+        ++_cursor.row;
+        _cursor.col = 1;
+      } else {
+        ++_cursor.col;
+      }
+    }
+    return _cursor;
+  }
+};
+
+/**
+\brief LR translation control that lexes each token in the context of the current parser state.
+
+Before reading a token, the context of the state on top of the pushdown is set; it contains the
+terminals that have an action in that state. Contexts are looked up once per state and then read
+from a table indexed by the state. Lexical analyzers other than ScannerlessLexicalAnalyzer are used
+as with LRTranslationControlTemplate.
+*/
+template <typename LRTableType>
+class ScannerlessTranslationControlTemplate : public LRTranslationControlTemplate<LRTableType> {
+ public:
+  using LRTranslationControlTemplate<LRTableType>::LRTranslationControlTemplate;
+
+  /**
+  \brief Sets translation grammar and discards the contexts of the previous table.
+
+  \param[in] tg The translation grammar for this translation.
+  \param[in] to_str The symbol printing function.
+  */
+  void set_grammar(const TranslationGrammar& tg,
+                   symbol_string_fn to_str = ctf::to_string) override {
+    LRTranslationControlTemplate<LRTableType>::set_grammar(tg, to_str);
+    _contexts.clear();
+  }
+
+ protected:
+  using LRTranslationControlTemplate<LRTableType>::next_token;
+
+  Token next_token(std::size_t state) override {
+    if (_contextsOwner != this->_lexicalAnalyzer) {
+      _contextsOwner = this->_lexicalAnalyzer;
+      _scanner = dynamic_cast<ScannerlessLexicalAnalyzer*>(this->_lexicalAnalyzer);
+      _contexts.clear();
+    }
+    if (_scanner) {
+      _scanner->set_context(context(state));
+    }
+    return next_token();
+  }
+
+ private:
+  static constexpr id_type unknown = std::numeric_limits<id_type>::max();
+
+  /**
+  \brief The lexical analyzer the contexts belong to.
+  */
+  const LexicalAnalyzer* _contextsOwner = nullptr;
+  ScannerlessLexicalAnalyzer* _scanner = nullptr;
+  /**
+  \brief The context of each state. unknown if not yet looked up.
+  */
+  vector<id_type> _contexts;
+
+  id_type context(std::size_t state) {
+    if (state >= _contexts.size()) {
+      _contexts.resize(std::max(state + 1, this->_lrTable.states()), unknown);
+    }
+    if (_contexts[state] == unknown) {
+      vector<bool> valid(this->_translationGrammar->terminals());
+      for (auto terminal = Symbol::eof(); terminal.id() < valid.size();
+           terminal = Terminal(terminal.id())) {
+        valid[terminal.id()] =
+          this->_lrTable.lr_action(state, terminal).action() != LRAction::ERROR;
+      }
+      _contexts[state] = _scanner->context(valid);
+    }
+    return _contexts[state];
+  }
+};
+
+using ScannerlessTranslationControl = ScannerlessTranslationControlTemplate<LSCELRTable>;
+using LR1ScannerlessTranslationControl = ScannerlessTranslationControlTemplate<LR1Table>;
+
+}  // namespace ctf
+
+#endif
+
+/*** End of file ctf_scannerless_translation_control.hpp ***/
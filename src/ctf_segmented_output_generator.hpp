@@ -0,0 +1,299 @@
+/**
+\file ctf_segmented_output_generator.hpp
+\brief Defines class SegmentedOutputGenerator, which generates output for independent segments of
+output tokens concurrently.
+\author Radek Vít
+*/
+#ifndef CTF_SEGMENTED_OUTPUT_GENERATOR_H
+#define CTF_SEGMENTED_OUTPUT_GENERATOR_H
+
+#include <atomic>
+#include <exception>
+#include <sstream>
+#include <system_error>
+#include <thread>
+
+#include "ctf_output_generator.hpp"
+
+namespace ctf {
+
+/**
+\brief Outputs tokens split into independent segments. Base class.
+
+The output token string is split at every occurrence of the marker terminal. The first segment
+contains all tokens before the first marker, every other segment starts with its marker token.
+Segments are processed concurrently by output_segment(); their outputs and error messages are
+concatenated in the order of the segments.
+*/
+class SegmentedOutputGenerator : public OutputGenerator {
+ public:
+  using const_iterator = tstack<Token>::const_iterator;
+
+  /**
+  \brief A single segment of output tokens. Buffers its output and error messages.
+  */
+  class Segment {
+   public:
+    /**
+    \brief Constructs a segment from a range of output tokens.
+
+    \param[in] index The position of this segment in the output.
+    \param[in] begin The first token of the segment.
+    \param[in] end The token beyond the last token of the segment.
+    \param[in] record Record warnings, errors and the text written to err() as diagnostics instead
+    of writing them to the error buffer.
+    */
+    Segment(std::size_t index, const_iterator begin, const_iterator end, bool record = false)
+      : _index(index), _begin(begin), _end(end), _record(record) {}
+
+    /**
+    \brief Get the position of this segment in the output.
+    */
+    std::size_t index() const noexcept { return _index; }
+    /**
+    \brief Get an iterator to the first token of this segment.
+    */
+    const_iterator begin() const noexcept { return _begin; }
+    /**
+    \brief Get an iterator beyond the last token of this segment.
+    */
+    const_iterator end() const noexcept { return _end; }
+
+    /**
+    \brief Get the output buffer of this segment.
+    */
+    std::ostream& os() noexcept { return _os; }
+    /**
+    \brief Get the error buffer of this segment. When recording, the written text is recorded in
+    order with the diagnostics of this segment.
+    */
+    std::ostream& err() noexcept { return _record ? _recordedErr : _err; }
+
+    /**
+    \brief Get the error flag.
+
+    \returns True when an error has been encountered in this segment.
+    */
+    bool error() const noexcept { return _errorFlag; }
+    /**
+    \brief Set the error flag.
+    */
+    void set_error() noexcept { _errorFlag = true; }
+
+    void warning(const string& message) {
+      if (_record) {
+        _diagnostics.warning(message);
+        return;
+      }
+      err() << output::color::yellow << "warning" << output::reset << ":\n" << message << "\n";
+    }
+    /**
+    \brief Outputs a warning message with the location automatically printed before it.
+    */
+    void warning(const const_iterator it, const string& message) {
+      if (_record) {
+        _diagnostics.warning(it->location(), message);
+        return;
+      }
+      err() << it->location().to_string() << ": " << output::color::yellow << "warning"
+            << output::reset << ":\n"
+            << message << "\n";
+    }
+
+    void error(const string& message) {
+      set_error();
+      if (_record) {
+        _diagnostics.error(message);
+        return;
+      }
+      err() << output::color::red << "ERROR" << output::reset << ":\n" << message << "\n";
+    }
+    /**
+    \brief Outputs an error message with the location automatically printed before it.
+    */
+    void error(const const_iterator it, const string& message) {
+      set_error();
+      if (_record) {
+        _diagnostics.error(it->location(), message);
+        return;
+      }
+      err() << it->location().to_string() << ": " << output::color::red << "ERROR"
+            << output::reset << ":\n"
+            << message << "\n";
+    }
+
+    [[noreturn]] void fatal_error(const string& message) {
+      error(message);
+      throw SemanticException("Semantic error encountered.");
+    }
+
+    [[noreturn]] void fatal_error(const_iterator it, const string& message) {
+      error(it, message);
+      throw SemanticException("Semantic error encountered.");
+    }
+
+   private:
+    friend class SegmentedOutputGenerator;
+
+    std::size_t _index;
+    const_iterator _begin;
+    const_iterator _end;
+    /**
+    \brief The buffered output of this segment.
+    */
+    std::stringstream _os;
+    /**
+    \brief The buffered error messages of this segment.
+    */
+    std::stringstream _err;
+    /**
+    \brief The recorded diagnostics of this segment, merged into the generator's sink.
+    */
+    DiagnosticSink _diagnostics;
+    DiagnosticStreamBuffer _errBuffer{_diagnostics};
+    /**
+    \brief The error buffer of a recording segment. Writes to _diagnostics.
+    */
+    std::ostream _recordedErr{&_errBuffer};
+    bool _record;
+    bool _errorFlag = false;
+    /**
+    \brief The exception thrown while processing this segment, if any.
+    */
+    std::exception_ptr _exception;
+  };
+
+  /**
+  \brief Constructs the generator with a segment marker.
+
+  \param[in] marker The terminal that starts a new segment.
+  \param[in] threads The maximum number of worker threads. 0 selects the hardware concurrency.
+  */
+  explicit SegmentedOutputGenerator(Symbol marker, std::size_t threads = 0)
+    : _marker(marker), _threads(threads) {}
+  /**
+  \brief Constructs the generator with an output stream and a segment marker.
+
+  \param[in] os The output stream.
+  \param[in] marker The terminal that starts a new segment.
+  \param[in] threads The maximum number of worker threads. 0 selects the hardware concurrency.
+  */
+  SegmentedOutputGenerator(std::ostream& os, Symbol marker, std::size_t threads = 0)
+    : OutputGenerator(os), _marker(marker), _threads(threads) {}
+
+  /**
+  \brief Splits tokens into segments, generates their output concurrently and outputs them in
+  order.
+
+  \param[in] tokens Output Tokens.
+
+  If a segment throws, the output and error messages of all segments up to and including that
+  segment are written and the exception is rethrown. If a worker thread cannot be started, the
+  segments are processed by the threads started so far.
+  */
+  void output(const tstack<Token>& tokens) override {
+    auto segments = split(tokens);
+
+    std::size_t workers = std::min(thread_count(), segments.size());
+    std::atomic<std::size_t> next{0};
+    auto work = [this, &segments, &next]() {
+      for (std::size_t i = next++; i < segments.size(); i = next++) {
+        auto& segment = segments[i];
+        try {
+          output_segment(segment);
+        } catch (...) {
+          segment._exception = std::current_exception();
+        }
+      }
+    };
+    if (workers <= 1) {
+      work();
+    } else {
+      vector<std::thread> threads;
+      threads.reserve(workers - 1);
+      for (std::size_t i = 1; i < workers; ++i) {
+        try {
+          threads.emplace_back(work);
+        } catch (std::system_error&) {
+          // the remaining segments are processed by the started threads and this thread
+          break;
+        }
+      }
+      work();
+      for (auto& thread : threads) {
+        thread.join();
+      }
+    }
+
+    // merge segments in order
+    auto& os = this->os();
+    auto& err = this->err();
+    for (auto& segment : segments) {
+      os << segment._os.str();
+      if (auto sink = diagnostics()) {
+        sink->append(segment._diagnostics);
+      }
+      err << segment._err.str();
+      if (segment.error()) {
+        set_error();
+      }
+      if (segment._exception) {
+        std::rethrow_exception(segment._exception);
+      }
+    }
+  }
+
+  /**
+  \brief Get the segment marker terminal.
+  */
+  Symbol marker() const noexcept { return _marker; }
+
+ protected:
+  /**
+  \brief Generates the output of a single segment. May be called concurrently for different
+  segments.
+
+  \param[in,out] segment The processed segment. All output and error messages must be written to
+  the segment's buffers.
+  */
+  virtual void output_segment(Segment& segment) = 0;
+
+ private:
+  /**
+  \brief The terminal that starts a new segment.
+  */
+  Symbol _marker;
+  /**
+  \brief The maximum number of worker threads.
+  */
+  std::size_t _threads;
+
+  std::size_t thread_count() const noexcept {
+    if (_threads != 0) {
+      return _threads;
+    }
+    return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+  }
+
+  /**
+  \brief Splits the output tokens into segments at each marker.
+  */
+  deque<Segment> split(const tstack<Token>& tokens) const {
+    deque<Segment> segments;
+    const bool record = diagnostics() != nullptr;
+    auto begin = tokens.begin();
+    for (auto it = tokens.begin(); it != tokens.end(); ++it) {
+      if (it->symbol() == _marker && it != begin) {
+        segments.emplace_back(segments.size(), begin, it, record);
+        begin = it;
+      }
+    }
+    segments.emplace_back(segments.size(), begin, tokens.end(), record);
+    return segments;
+  }
+};
+}  // namespace ctf
+
+#endif
+
+/*** End of file ctf_segmented_output_generator.hpp ***/
@@ -11,9 +11,15 @@
 #include <ostream>
 #include <sstream>
 
-#include "ctf_lexical_analyzer.hpp"
+#include "ctf_dfa_lexical_analyzer.hpp"
+#include "ctf_diagnostics.hpp"
+#include "ctf_glr_translation_control.hpp"
+#include "ctf_grammar_registry.hpp"
+#include "ctf_layout_lexical_analyzer.hpp"
 #include "ctf_lr_translation_control.hpp"
 #include "ctf_output_generator.hpp"
+#include "ctf_scannerless_translation_control.hpp"
+#include "ctf_segmented_output_generator.hpp"
 #include "ctf_translation_control.hpp"
 #include "ctf_translation_grammar.hpp"
 
@@ -32,6 +38,9 @@ enum class TranslationResult {
 using CanonicalLR1 = LR1TranslationControl;
 using LALR = LALRTranslationControl;
 using LSCELR = LSCELRTranslationControl;
+using Auto = AutoTranslationControl;
+using GLR = GLRTranslationControl;
+using Scannerless = ScannerlessTranslationControl;
 
 inline SavedLRTranslationControl load(std::istream& is) { return SavedLRTranslationControl(is); }
 
@@ -105,6 +114,34 @@ class Translation {
     _translationControl.set_grammar(_translationGrammar, _toString);
   }
 
+  /**
+  \brief Constructs Translation with a translation control that supplies its own translation
+  grammar, such as VersionedLRTranslationControl.
+  \param[in] la A callable to perform lexical analysis.
+  \param[in] tc A translation control to drive the translation.
+  \param[in] og A callable to perform output generation.
+  \param[in] to_str The function for string representaton of symbols.
+  */
+  Translation(TLexicalAnalyzer&& la,
+              TTranslationControl&& tc,
+              TOutputGenerator&& og,
+              symbol_string_fn to_str = ctf::to_string)
+    : _lexicalAnalyzer(std::move(la))
+    , _translationControl(std::move(tc))
+    , _outputGenerator(std::move(og))
+    , _toString(to_str) {
+    _translationControl.set_lexical_analyzer(_lexicalAnalyzer);
+  }
+
+  /**
+  \brief Translation is neither copyable nor movable. Its translation control and error stream
+  refer to its other members.
+  */
+  Translation(const Translation&) = delete;
+  Translation(Translation&&) = delete;
+  Translation& operator=(const Translation&) = delete;
+  Translation& operator=(Translation&&) = delete;
+
   ~Translation() {}  //= default;
 
   /**
@@ -115,11 +152,93 @@ class Translation {
   \param[in] inputName The name of the input stream. Defaults to "".
 
   \returns True when no errors were encountered.
+
+  Warnings and errors are recorded during the translation and written to errorStream in a single
+  write at its end, also when an exception escapes the translation. Text written directly to the
+  error stream of a component is recorded in order with them.
   */
   TranslationResult run(std::istream& inputStream,
                         std::ostream& outputStream,
                         std::ostream& errorStream,
                         const std::string& inputName = "") {
+    _diagnostics.clear();
+    _lexicalAnalyzer.set_diagnostics(_diagnostics);
+    _translationControl.set_diagnostics(_diagnostics);
+    _outputGenerator.set_diagnostics(_diagnostics);
+
+    TranslationResult result;
+    try {
+      result = translate(inputStream, outputStream, _errors, inputName);
+    } catch (...) {
+      _diagnostics.render(errorStream, _diagnosticFormat);
+      throw;
+    }
+    _diagnostics.render(errorStream, _diagnosticFormat);
+    return result;
+  }
+
+  void save(std::ostream& os) const { _translationControl.save(os); }
+
+  /**
+  \brief Get the translation control.
+  */
+  const TTranslationControl& translation_control() const noexcept { return _translationControl; }
+
+  /**
+  \brief Get the diagnostics recorded by the last run.
+  */
+  const DiagnosticSink& diagnostics() const noexcept { return _diagnostics; }
+
+  /**
+  \brief Sets the format in which diagnostics are written to the error stream.
+
+  \param[in] format The diagnostic format. Defaults to DiagnosticFormat::COLOR.
+  */
+  void set_diagnostic_format(DiagnosticFormat format) noexcept { _diagnosticFormat = format; }
+
+ protected:
+  /**
+  \brief The input reader and buffer.
+  */
+  InputReader _reader;
+  /**
+  \brief Provides input terminals from istream.
+  */
+  TLexicalAnalyzer _lexicalAnalyzer;
+  /**
+  \brief The control class performing the translation.
+  */
+  TTranslationControl _translationControl;
+  /**
+  \brief A translation grammar that defines accepted language and output
+  language.
+  */
+  TranslationGrammar _translationGrammar;
+  /**
+  \brief Outputs output terminals to ostream or elsewhere.
+  */
+  TOutputGenerator _outputGenerator;
+
+  symbol_string_fn _toString;
+
+  /**
+  \brief Warnings and errors of the current translation.
+  */
+  DiagnosticSink _diagnostics;
+  DiagnosticFormat _diagnosticFormat = DiagnosticFormat::COLOR;
+  /**
+  \brief The error stream of all components. Records the written text in _diagnostics.
+  */
+  DiagnosticStreamBuffer _errorBuffer{_diagnostics};
+  std::ostream _errors{&_errorBuffer};
+
+  /**
+  \brief Runs all phases of the translation.
+  */
+  TranslationResult translate(std::istream& inputStream,
+                              std::ostream& outputStream,
+                              std::ostream& errorStream,
+                              const std::string& inputName) {
     // extra output buffer
     std::stringstream ss;
     // error flags
@@ -173,33 +292,6 @@ class Translation {
     outputStream << ss.str();
     return TranslationResult::SUCCESS;
   }
-
-  void save(std::ostream& os) const { _translationControl.save(os); }
-
- protected:
-  /**
-  \brief The input reader and buffer.
-  */
-  InputReader _reader;
-  /**
-  \brief Provides input terminals from istream.
-  */
-  TLexicalAnalyzer _lexicalAnalyzer;
-  /**
-  \brief The control class performing the translation.
-  */
-  TTranslationControl _translationControl;
-  /**
-  \brief A translation grammar that defines accepted language and output
-  language.
-  */
-  TranslationGrammar _translationGrammar;
-  /**
-  \brief Outputs output terminals to ostream or elsewhere.
-  */
-  TOutputGenerator _outputGenerator;
-
-  symbol_string_fn _toString;
 };
 }  // namespace ctf
 
@@ -6,6 +6,7 @@
 #ifndef CTF_TRANSLATION_CONTROL_H
 #define CTF_TRANSLATION_CONTROL_H
 
+#include "ctf_diagnostics.hpp"
 #include "ctf_lexical_analyzer.hpp"
 #include "ctf_translation_grammar.hpp"
 
@@ -67,6 +68,18 @@ class TranslationControl {
   */
   void set_error_stream(std::ostream& os) { _error = &os; }
 
+  /**
+  \brief Set the diagnostic sink. Errors are recorded in the sink instead of being written to the
+  error stream.
+
+  \param[in] sink The diagnostic sink to be set.
+  */
+  void set_diagnostics(DiagnosticSink& sink) noexcept { _diagnostics = &sink; }
+  /**
+  \brief Removes the diagnostic sink. Errors are written to the error stream.
+  */
+  void remove_diagnostics() noexcept { _diagnostics = nullptr; }
+
   /**
   \brief Runs translation. Translation output is stored in _output.
   */
@@ -112,6 +125,11 @@ class TranslationControl {
   */
   bool _errorFlag = false;
 
+  /**
+  \brief The diagnostic sink. Messages are written to the error stream if not set.
+  */
+  DiagnosticSink* _diagnostics = nullptr;
+
   /**
   \brief Returns the next token obtained from _lexicalAnalyzer.
   */
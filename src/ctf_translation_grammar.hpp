@@ -232,7 +232,10 @@ class Rule {
 
   explicit operator string() const { return to_string(); }
 
-  std::size_t id = -1;
+  /**
+  \brief The index of this rule in its translation grammar.
+  */
+  id_type id = std::numeric_limits<id_type>::max();
 
  protected:
   /**
@@ -514,7 +517,7 @@ class TranslationGrammar {
 
   void mark_rules() {
     for (std::size_t i = 0; i < _rules.size(); ++i) {
-      _rules[i].id = i;
+      _rules[i].id = static_cast<id_type>(i);
     }
   }
 
@@ -522,6 +525,10 @@ class TranslationGrammar {
    * Transforms a translation grammar into an augmented translation grammar.
    */
   void make_augmented() {
+    // all identifiers, including the augmented rule and starting symbol, must fit in id_type
+    narrow_id(_terminals, "The number of terminals");
+    narrow_id(_nonterminals + 1, "The number of nonterminals");
+    narrow_id(_rules.size() + 1, "The number of rules");
     // create a new unique starting symbol
     Symbol newStartingNonterminal = Nonterminal(_nonterminals);
     ++_nonterminals;
@@ -531,6 +538,128 @@ class TranslationGrammar {
     _startingSymbol = newStartingNonterminal;
   }
 };
+
+/**
+\brief The rules of a translation grammar packed into contiguous arrays for translation controls.
+
+Each rule is described by a small record. The input and output symbols of all rules are stored in
+a single array and the attribute actions are precompiled into attribute plans stored in another.
+The packed rules are a snapshot; later modifications of the grammar are not reflected.
+*/
+class PackedRules {
+ public:
+  /**
+  \brief The packed data of a single rule.
+  */
+  struct Record {
+    /**
+    \brief The left-hand side of the rule.
+    */
+    Symbol nonterminal;
+    id_type inputSize;
+    id_type outputSize;
+    /**
+    \brief The offset of the input symbols in the symbol array. Output symbols follow them.
+    */
+    id_type symbols;
+    /**
+    \brief The offset of the attribute plan in the plan array.
+    */
+    id_type plan;
+  };
+
+  /**
+  \brief A range of packed symbols.
+  */
+  struct SymbolRange {
+    const Symbol* first;
+    const Symbol* last;
+
+    const Symbol* begin() const noexcept { return first; }
+    const Symbol* end() const noexcept { return last; }
+    std::size_t size() const noexcept { return static_cast<std::size_t>(last - first); }
+  };
+
+  PackedRules() = default;
+  /**
+  \brief Packs the rules of a translation grammar.
+
+  \param[in] grammar The translation grammar.
+
+  The attribute plan of a rule starts with the number of input terminals. For each input terminal,
+  it contains the number of its attribute targets followed by the distance of each target from
+  the last output symbol, in ascending order. Targets that are not output terminals are omitted.
+  */
+  explicit PackedRules(const TranslationGrammar& grammar) {
+    auto& rules = grammar.rules();
+    _records.reserve(rules.size());
+    for (auto& rule : rules) {
+      auto& output = rule.output();
+      _records.push_back({rule.nonterminal(),
+                          static_cast<id_type>(rule.input().size()),
+                          static_cast<id_type>(output.size()),
+                          static_cast<id_type>(_symbols.size()),
+                          static_cast<id_type>(_plans.size())});
+      _symbols.insert(_symbols.end(), rule.input().begin(), rule.input().end());
+      _symbols.insert(_symbols.end(), output.begin(), output.end());
+
+      _plans.push_back(static_cast<id_type>(rule.actions().size()));
+      for (auto& targets : rule.actions()) {
+        std::size_t count = _plans.size();
+        _plans.push_back(0);
+        // targets are sorted in ascending order, distances in descending order
+        for (auto it = targets.end(); it != targets.begin();) {
+          std::size_t target = *--it;
+          if (target < output.size() && output[target].terminal()) {
+            _plans.push_back(static_cast<id_type>(output.size() - target - 1));
+            ++_plans[count];
+          }
+        }
+      }
+    }
+    // all offsets stored in the records are bounded by these sizes
+    narrow_id(_symbols.size(), "The number of packed rule symbols");
+    narrow_id(_plans.size(), "The size of packed attribute plans");
+  }
+
+  /**
+  \brief Get the record of a rule.
+
+  \param[in] rule The index of the rule.
+  */
+  const Record& operator[](std::size_t rule) const noexcept { return _records[rule]; }
+
+  /**
+  \brief Get the number of rules.
+  */
+  std::size_t size() const noexcept { return _records.size(); }
+
+  /**
+  \brief Get the input symbols of a rule.
+  */
+  SymbolRange input(const Record& record) const noexcept {
+    const Symbol* first = _symbols.data() + record.symbols;
+    return {first, first + record.inputSize};
+  }
+
+  /**
+  \brief Get the output symbols of a rule.
+  */
+  SymbolRange output(const Record& record) const noexcept {
+    const Symbol* first = _symbols.data() + record.symbols + record.inputSize;
+    return {first, first + record.outputSize};
+  }
+
+  /**
+  \brief Get a pointer to the attribute plan of a rule.
+  */
+  const id_type* plan(const Record& record) const noexcept { return _plans.data() + record.plan; }
+
+ private:
+  vector<Record> _records;
+  vector<Symbol> _symbols;
+  vector<id_type> _plans;
+};
 }  // namespace ctf
 #endif
 
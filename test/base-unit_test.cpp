@@ -26,6 +26,23 @@ TEST_CASE("Symbol construction and assignment", "[Symbol]") {
   REQUIRE(std::is_trivially_assignable<Symbol, Symbol&&>::value);
 }
 
+TEST_CASE("Symbol storage", "[Symbol]") {
+  using namespace ctf::literals;
+  REQUIRE(sizeof(Symbol) == sizeof(ctf::id_type));
+
+  constexpr std::size_t maxId = (std::size_t{1} << (sizeof(ctf::id_type) * 8 - 2)) - 1;
+  REQUIRE(ctf::Nonterminal(maxId).id() == maxId);
+  REQUIRE(ctf::Nonterminal(maxId).nonterminal());
+  REQUIRE(ctf::Terminal(maxId - 1).id() == maxId);
+  REQUIRE(ctf::Terminal(maxId - 1).terminal());
+  REQUIRE(Symbol::eof().type() == Symbol::Type::EOI);
+  REQUIRE(Symbol::eof().terminal());
+
+  REQUIRE(ctf::max_id == maxId);
+  REQUIRE(ctf::narrow_id(maxId, "id") == maxId);
+  REQUIRE_THROWS_AS(ctf::narrow_id(maxId + 1, "id"), std::invalid_argument);
+}
+
 TEST_CASE("Symbol operators", "[Symbol]") {
   using namespace ctf::literals;
   using ctf::Token;
@@ -80,6 +97,40 @@ TEST_CASE("Token Construction", "[Token]") {
   REQUIRE(s.to_string() == "EOF");
 }
 
+static std::size_t conversions = 0;
+
+static std::size_t to_size(const std::string& s) {
+  ++conversions;
+  return std::stoull(s);
+}
+
+TEST_CASE("Attribute deferred conversion", "[Attribute]") {
+  conversions = 0;
+  Attribute a = Attribute::deferred("42"s, to_size);
+  REQUIRE_FALSE(a.empty());
+  REQUIRE(a.is_deferred());
+
+  // copying does not convert the lexeme
+  Attribute b = a;
+  Token t(ctf::Terminal(0), a);
+  REQUIRE(conversions == 0);
+
+  REQUIRE(a.get<std::size_t>() == 42);
+  REQUIRE_FALSE(a.is_deferred());
+  REQUIRE(a.type() == typeid(std::size_t));
+  REQUIRE(a.get<std::size_t>() == 42);
+  REQUIRE(conversions == 1);
+
+  REQUIRE(b.is_deferred());
+  REQUIRE(b == std::size_t{42});
+  REQUIRE(conversions == 2);
+  REQUIRE(t.attribute().is_deferred());
+
+  Attribute c = Attribute::deferred("x"s, +[](const std::string& s) { return s + s; });
+  REQUIRE(c.get<std::string>() == "xx");
+  REQUIRE_THROWS_AS(c.get<std::size_t>(), std::bad_any_cast);
+}
+
 TEST_CASE("Token operators", "[Token]") {
   using namespace ctf::literals;
   using ctf::Token;
@@ -0,0 +1,198 @@
+#include <catch.hpp>
+#include <random>
+#include <sstream>
+
+#include "../src/ctf_dfa_lexical_analyzer.hpp"
+
+using ctf::DFALexicalAnalyzer;
+using ctf::InputReader;
+using ctf::Lexeme;
+using ctf::LexemeKind;
+using ctf::LexerDFA;
+using ctf::Location;
+using ctf::Symbol;
+using ctf::Token;
+using ctf::TokenPattern;
+using namespace ctf::literals;
+
+namespace {
+constexpr Symbol identifier = 0_t;
+constexpr Symbol number = 1_t;
+constexpr Symbol dot = 2_t;
+constexpr Symbol ellipsis = 3_t;
+
+/**
+\brief Identifiers, numbers, "." and "...", whitespace and comments from '#' to the end of line.
+*/
+LexerDFA make_dfa() {
+  LexerDFA dfa;
+  auto id = dfa.add_state();
+  auto num = dfa.add_state();
+  auto dot1 = dfa.add_state();
+  auto dot2 = dfa.add_state();
+  auto dot3 = dfa.add_state();
+  auto space = dfa.add_state();
+  auto comment = dfa.add_state();
+
+  dfa.add_transitions(LexerDFA::start, 'a', 'z', id);
+  dfa.add_transitions(id, 'a', 'z', id);
+  dfa.add_transitions(id, '0', '9', id);
+  dfa.set_token(id, identifier);
+
+  dfa.add_transitions(LexerDFA::start, '0', '9', num);
+  dfa.add_transitions(num, '0', '9', num);
+  dfa.set_token(num, number);
+
+  dfa.add_transition(LexerDFA::start, '.', dot1);
+  dfa.add_transition(dot1, '.', dot2);
+  dfa.add_transition(dot2, '.', dot3);
+  dfa.set_token(dot1, dot);
+  dfa.set_token(dot3, ellipsis);
+
+  for (auto state : {LexerDFA::start, space}) {
+    dfa.add_transition(state, ' ', space);
+    dfa.add_transition(state, '\n', space);
+  }
+  dfa.set_skip(space);
+
+  dfa.add_transition(LexerDFA::start, '#', comment);
+  dfa.add_transitions(comment, 0, '\n' - 1, comment);
+  dfa.add_transitions(comment, '\n' + 1, 255, comment);
+  dfa.set_skip(comment);
+  return dfa;
+}
+
+const LexerDFA dfa = make_dfa();
+
+class Lex : public DFALexicalAnalyzer {
+ public:
+  using DFALexicalAnalyzer::DFALexicalAnalyzer;
+
+ protected:
+  ctf::Attribute attribute(Symbol, std::string_view text) override {
+    return ctf::Attribute(ctf::string(text));
+  }
+};
+}  // namespace
+
+TEST_CASE("LexerDFA longest match", "[LexerDFA]") {
+  std::string input = "ab1 .. .... 12#c\n$";
+  auto lexemes = dfa.lex(input);
+  ctf::vector<Lexeme> expected{
+    {0, 3, identifier, LexemeKind::TOKEN},
+    {3, 4, Symbol::eof(), LexemeKind::SKIP},
+    {4, 5, dot, LexemeKind::TOKEN},
+    {5, 6, dot, LexemeKind::TOKEN},
+    {6, 7, Symbol::eof(), LexemeKind::SKIP},
+    {7, 10, ellipsis, LexemeKind::TOKEN},
+    {10, 11, dot, LexemeKind::TOKEN},
+    {11, 12, Symbol::eof(), LexemeKind::SKIP},
+    {12, 14, number, LexemeKind::TOKEN},
+    {14, 16, Symbol::eof(), LexemeKind::SKIP},
+    {16, 17, Symbol::eof(), LexemeKind::SKIP},
+    {17, 18, Symbol::eof(), LexemeKind::ERROR},
+  };
+  CHECK(lexemes == expected);
+  CHECK(dfa.lex("").empty());
+}
+
+TEST_CASE("LexerDFA parallel lexing", "[LexerDFA]") {
+  const char alphabet[] = "ab1.. .\n#$";
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<std::size_t> character(0, sizeof(alphabet) - 2);
+  for (std::size_t length : {1, 10, 100, 1000}) {
+    std::string input;
+    for (std::size_t i = 0; i < length; ++i) {
+      input += alphabet[character(generator)];
+    }
+    auto sequential = dfa.lex(input);
+    for (std::size_t chunkSize : {1, 2, 3, 7, 64}) {
+      INFO("length " << length << ", chunk size " << chunkSize);
+      CHECK(dfa.lex(input, 4, chunkSize) == sequential);
+    }
+  }
+
+  SECTION("lexemes spanning chunks") {
+    std::string input = "#" + std::string(100, 'x') + "\nabc ...";
+    auto sequential = dfa.lex(input);
+    REQUIRE(sequential.size() == 5);
+    CHECK(dfa.lex(input, 3, 8) == sequential);
+    CHECK(dfa.lex(input, 0, 8) == sequential);
+  }
+}
+
+TEST_CASE("LexerDFA patterns", "[LexerDFA]") {
+  constexpr Symbol keyword = 4_t;
+  constexpr Symbol string = 5_t;
+  LexerDFA compiled = LexerDFA::compile({
+    {"if|else", keyword},
+    {"[a-z][a-z0-9]*", identifier},
+    {"\\d+", number},
+    {"\\.", dot},
+    {"\\.\\.\\.", ellipsis},
+    {"\"([^\"\\\\\\n]|\\\\.)*\"", string},
+    {"[ \\n]+|#.*", Symbol::eof(), LexemeKind::SKIP},
+  });
+
+  // the hand-written automaton has the same lexemes
+  std::string input = "ab1 .. .... 12#c\n$";
+  CHECK(compiled.lex(input) == dfa.lex(input));
+
+  auto lexemes = compiled.lex("if ifx else\"a\\\"b\" \"\n");
+  ctf::vector<Lexeme> expected{
+    {0, 2, keyword, LexemeKind::TOKEN},
+    {2, 3, Symbol::eof(), LexemeKind::SKIP},
+    {3, 6, identifier, LexemeKind::TOKEN},
+    {6, 7, Symbol::eof(), LexemeKind::SKIP},
+    {7, 11, keyword, LexemeKind::TOKEN},
+    {11, 17, string, LexemeKind::TOKEN},
+    {17, 18, Symbol::eof(), LexemeKind::SKIP},
+    {18, 19, Symbol::eof(), LexemeKind::ERROR},
+    {19, 20, Symbol::eof(), LexemeKind::SKIP},
+  };
+  CHECK(lexemes == expected);
+
+  for (const char* pattern : {"(a", "a)", "[a", "*a", "a|+", "[z-a]", "a\\"}) {
+    INFO(pattern);
+    CHECK_THROWS_AS(LexerDFA::compile({{pattern, identifier}}), std::invalid_argument);
+  }
+}
+
+TEST_CASE("DFALexicalAnalyzer", "[DFALexicalAnalyzer]") {
+  std::stringstream s;
+  std::stringstream err;
+  InputReader r{s, "file"};
+  Lex l{dfa, 2, 4};
+  l.set_reader(r);
+  l.set_error_stream(err);
+  s << "abc 12\n  ... # x\nx.";
+
+  ctf::vector<Token> tokens;
+  for (Token t = l.get_token(); t != Symbol::eof(); t = l.get_token()) {
+    tokens.push_back(t);
+  }
+  REQUIRE(tokens.size() == 5);
+  CHECK(tokens[0] == identifier);
+  CHECK(tokens[0].attribute().get<ctf::string>() == "abc");
+  CHECK(tokens[0].location() == Location{1, 1, "file"});
+  CHECK(tokens[1] == number);
+  CHECK(tokens[1].location() == Location{1, 5, "file"});
+  CHECK(tokens[2] == ellipsis);
+  CHECK(tokens[2].location() == Location{2, 3, "file"});
+  CHECK(tokens[3] == identifier);
+  CHECK(tokens[3].location() == Location{3, 1, "file"});
+  CHECK(tokens[4] == dot);
+  CHECK(tokens[4].attribute().get<ctf::string>() == ".");
+  CHECK(l.get_token().location() == Location{3, 3, "file"});
+  CHECK_FALSE(l.error());
+
+  SECTION("lexical errors") {
+    std::stringstream s2("a $");
+    r.set_stream(s2);
+    l.reset();
+    CHECK(l.get_token() == identifier);
+    CHECK_THROWS_AS(l.get_token(), ctf::LexicalException);
+    CHECK(l.error());
+    CHECK(err.str().find("Unexpected character '$'.") != std::string::npos);
+  }
+}
@@ -0,0 +1,147 @@
+#include <catch.hpp>
+
+#include <sstream>
+#include "../src/ctf_diagnostics.hpp"
+#include "../src/ctf_output_generator.hpp"
+
+using ctf::DiagnosticFormat;
+using ctf::DiagnosticSink;
+using ctf::Location;
+using ctf::Severity;
+
+using namespace ctf::literals;
+
+TEST_CASE("DiagnosticSink recording", "[DiagnosticSink]") {
+  DiagnosticSink sink;
+  REQUIRE(sink.empty());
+
+  sink.warning(Location(1, 2, "a"), "first");
+  sink.error(Location(3, 4, "a"), "second");
+  sink.error("third");
+  sink.warning(Location(5, 6, "b"), "fourth");
+
+  REQUIRE(sink.diagnostics().size() == 4);
+  REQUIRE(sink.errors() == 2);
+  REQUIRE(sink.warnings() == 2);
+  // source names are stored once
+  REQUIRE(sink.diagnostics()[0].source == sink.diagnostics()[1].source);
+  REQUIRE(sink.source(sink.diagnostics()[3].source) == "b");
+  REQUIRE_FALSE(sink.diagnostics()[2].located);
+
+  sink.clear();
+  REQUIRE(sink.empty());
+  REQUIRE(sink.errors() == 0);
+}
+
+TEST_CASE("DiagnosticSink rendering", "[DiagnosticSink]") {
+  DiagnosticSink sink;
+  sink.warning(Location(1, 2, "a"), "first");
+  sink.error("second \"quoted\"");
+  sink.error(Location::invalid(), "third");
+
+  SECTION("plain") {
+    REQUIRE(sink.to_string(DiagnosticFormat::PLAIN) ==
+            "a:1:2: warning:\nfirst\nERROR:\nsecond \"quoted\"\n: ERROR:\nthird\n");
+  }
+  SECTION("color") {
+    std::stringstream expected;
+    expected << "a:1:2: " << ctf::output::color::yellow << "warning" << ctf::output::reset
+             << ":\nfirst\n"
+             << ctf::output::color::red << "ERROR" << ctf::output::reset
+             << ":\nsecond \"quoted\"\n: " << ctf::output::color::red << "ERROR"
+             << ctf::output::reset << ":\nthird\n";
+    std::stringstream ss;
+    sink.render(ss);
+    REQUIRE(ss.str() == expected.str());
+  }
+  SECTION("json") {
+    REQUIRE(sink.to_string(DiagnosticFormat::JSON) ==
+            "[\n"
+            "  {\"severity\": \"warning\", \"source\": \"a\", \"row\": 1, \"col\": 2, "
+            "\"message\": \"first\"},\n"
+            "  {\"severity\": \"error\", \"message\": \"second \\\"quoted\\\"\"},\n"
+            "  {\"severity\": \"error\", \"message\": \"third\"}\n"
+            "]\n");
+  }
+  SECTION("append") {
+    DiagnosticSink other;
+    other.error(Location(7, 8, "c"), "appended");
+    sink.append(other);
+    REQUIRE(sink.errors() == 3);
+    REQUIRE(sink.to_string(DiagnosticFormat::PLAIN).find("c:7:8: ERROR:\nappended\n") !=
+            std::string::npos);
+  }
+}
+
+TEST_CASE("DiagnosticSink text", "[DiagnosticSink]") {
+  DiagnosticSink sink;
+  ctf::DiagnosticStreamBuffer buffer(sink);
+  std::ostream err(&buffer);
+
+  err << "before" << ' ' << 1 << '\n';
+  sink.error("first");
+  sink.error("second");
+  err << "between\n";
+  sink.warning("third");
+  err << "after\n";
+
+  REQUIRE(sink.errors() == 2);
+  REQUIRE(sink.to_string(DiagnosticFormat::PLAIN) ==
+          "before 1\nERROR:\nfirst\nERROR:\nsecond\nbetween\nwarning:\nthird\nafter\n");
+  REQUIRE(sink.to_string(DiagnosticFormat::JSON) ==
+          "[\n"
+          "  {\"text\": \"before 1\\n\"},\n"
+          "  {\"severity\": \"error\", \"message\": \"first\"},\n"
+          "  {\"severity\": \"error\", \"message\": \"second\"},\n"
+          "  {\"text\": \"between\\n\"},\n"
+          "  {\"severity\": \"warning\", \"message\": \"third\"},\n"
+          "  {\"text\": \"after\\n\"}\n"
+          "]\n");
+
+  SECTION("append") {
+    DiagnosticSink other;
+    other.error("fourth");
+    ctf::DiagnosticStreamBuffer otherBuffer(other);
+    std::ostream(&otherBuffer) << "appended\n";
+    sink.append(other);
+    REQUIRE(sink.to_string(DiagnosticFormat::PLAIN) ==
+            "before 1\nERROR:\nfirst\nERROR:\nsecond\nbetween\nwarning:\nthird\nafter\n"
+            "ERROR:\nfourth\nappended\n");
+  }
+  SECTION("render") {
+    DiagnosticSink textOnly;
+    textOnly.text("only text\n");
+    std::stringstream ss;
+    textOnly.render(ss);
+    REQUIRE(ss.str() == "only text\n");
+    textOnly.clear();
+    ss.str("");
+    textOnly.render(ss);
+    REQUIRE(ss.str() == "");
+  }
+}
+
+TEST_CASE("DiagnosticSink in OutputGenerator", "[DiagnosticSink]") {
+  class ErrorOutput : public ctf::OutputGenerator {
+   public:
+    using OutputGenerator::OutputGenerator;
+
+    void output(const ctf::tstack<ctf::Token>& tokens) override {
+      warning(tokens.begin(), "located warning");
+      error("error");
+    }
+  };
+  std::stringstream os;
+  std::stringstream err;
+  DiagnosticSink sink;
+  ErrorOutput o{os};
+  o.set_error_stream(err);
+  o.set_diagnostics(sink);
+
+  o.output({ctf::Token(0_t, {}, Location(2, 3, "f"))});
+  // nothing is written until the sink is rendered
+  REQUIRE(err.str() == "");
+  REQUIRE(o.error());
+  REQUIRE(sink.to_string(DiagnosticFormat::PLAIN) ==
+          "f:2:3: warning:\nlocated warning\nERROR:\nerror\n");
+}
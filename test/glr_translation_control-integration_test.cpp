@@ -0,0 +1,233 @@
+#include <catch.hpp>
+
+#include <sstream>
+#include "../src/ctf_glr_translation_control.hpp"
+
+using ctf::GLRTranslationControl;
+using ctf::InputReader;
+using ctf::LexicalAnalyzer;
+using ctf::LR1GLRTranslationControl;
+using ctf::Nonterminal;
+using ctf::string;
+using ctf::Symbol;
+using ctf::Terminal;
+using ctf::Token;
+using ctf::TranslationGrammar;
+using ctf::vector;
+
+namespace {
+/**
+\brief Every character of this string is a terminal with the id of its position.
+*/
+const string terminals = "abinx;+()";
+
+Symbol t(char c) { return Terminal(terminals.find(c)); }
+
+/**
+\brief Reads single character terminals. Each token's attribute is its position in the input.
+*/
+class GLRLA : public LexicalAnalyzer {
+ public:
+  using LexicalAnalyzer::LexicalAnalyzer;
+
+  Token read_token() override {
+    int c = get();
+    while (c == ' ') {
+      reset_location();
+      c = get();
+    }
+    if (c == std::char_traits<char>::eof()) {
+      return token_eof();
+    }
+    return token(t(static_cast<char>(c)), ctf::Attribute(_position++));
+  }
+
+  void reset_private() override { _position = 0; }
+
+ private:
+  std::size_t _position = 0;
+};
+
+template <typename Control>
+string translate(Control& control, GLRLA& la, const string& input) {
+  std::stringstream in(input);
+  std::stringstream err;
+  InputReader r{in};
+  la.set_reader(r);
+  la.reset();
+  la.set_error_stream(err);
+  control.reset();
+  control.set_error_stream(err);
+  control.run(r);
+  if (control.error()) {
+    return "error";
+  }
+  string output;
+  for (auto& token : control.output()) {
+    if (token != Symbol::eof()) {
+      output += terminals[token.symbol().id() - 1];
+    }
+  }
+  return output;
+}
+}  // namespace
+
+TEST_CASE("GLR ambiguous expressions", "[GLRTranslationControl]") {
+  auto E = Nonterminal(0);
+  // E -> E + E | n, translated to postfix
+  TranslationGrammar tg{{
+                          {E, {E, t('+'), E}, {E, E, t('+')}, {{2}}},
+                          {E, {t('n')}, {t('n')}, {{0}}},
+                        },
+                        E};
+  GLRLA la;
+  GLRTranslationControl glr(la, tg);
+  REQUIRE(glr.lr_table().unresolved_conflicts() > 0);
+
+  CHECK(translate(glr, la, "n") == "n");
+  CHECK(glr.generalized_tokens() == 0);
+  CHECK(translate(glr, la, "n + n") == "nn+");
+  CHECK(glr.generalized_tokens() == 0);
+  // shifts are preferred
+  CHECK(translate(glr, la, "n + n + n") == "nnn++");
+  CHECK(glr.generalized_tokens() > 0);
+  CHECK(glr.ambiguities() == 1);
+  // attributes are assigned to the tokens of the selected parse
+  auto it = glr.output().begin();
+  for (std::size_t position : {0, 2, 4, 3, 1}) {
+    CHECK(it++->attribute().template get<std::size_t>() == position);
+  }
+  CHECK(translate(glr, la, "n + n + n + n") == "nnnn+++");
+  CHECK(glr.ambiguities() > 1);
+  CHECK(translate(glr, la, "n + + n") == "error");
+  CHECK(translate(glr, la, "n + n +") == "error");
+}
+
+TEST_CASE("GLR deterministic stretches", "[GLRTranslationControl]") {
+  auto L = Nonterminal(0), S = Nonterminal(1), E = Nonterminal(2);
+  TranslationGrammar tg{{
+                          {L, {L, S}},
+                          {L, {S}},
+                          {S, {t('i'), t(';')}, {t('i')}, {{0}, {}}},
+                          {S, {E, t(';')}, {E, t(';')}, {{1}}},
+                          {E, {E, t('+'), E}, {E, E, t('+')}, {{2}}},
+                          {E, {t('n')}, {t('n')}, {{0}}},
+                        },
+                        L};
+  GLRLA la;
+  GLRTranslationControl glr(la, tg);
+
+  CHECK(translate(glr, la, "i ; n + n ; i ;") == "inn+;i");
+  CHECK(glr.generalized_tokens() == 0);
+  CHECK(translate(glr, la, "i ; n + n + n ; i ; i ; i ; i ;") == "innn++;iiii");
+  // the pushdown is restored once the ambiguous expression is reduced
+  CHECK(glr.generalized_tokens() > 0);
+  CHECK(glr.generalized_tokens() <= 4);
+  CHECK(translate(glr, la, "n + n + n ; n + n + n ;") == "nnn++;nnn++;");
+  CHECK(glr.ambiguities() == 2);
+  CHECK(translate(glr, la, "i ; n + n + ; i ;") == "error");
+}
+
+TEST_CASE("GLR error recovery", "[GLRTranslationControl]") {
+  /**
+  \brief Pops the pushdown until the erroneous token has an action.
+  */
+  class RecoveringGLR : public GLRTranslationControl {
+   public:
+    using GLRTranslationControl::GLRTranslationControl;
+
+    std::size_t recoveries = 0;
+
+   protected:
+    bool error_recovery(vector<ctf::id_type>& pushdown, Token& token) override {
+      ++recoveries;
+      auto action = [&]() { return _lrTable.lr_action(pushdown.back(), token.symbol()).action(); };
+      while (pushdown.size() > 1 && action() == ctf::LRAction::ERROR) {
+        pushdown.pop_back();
+      }
+      return action() != ctf::LRAction::ERROR;
+    }
+  };
+  auto L = Nonterminal(0), S = Nonterminal(1), E = Nonterminal(2);
+  TranslationGrammar tg{{
+                          {L, {L, S}},
+                          {L, {S}},
+                          {S, {t('i'), t(';')}, {t('i')}, {{0}, {}}},
+                          {S, {E, t(';')}, {E, t(';')}, {{1}}},
+                          {E, {E, t('+'), E}, {E, E, t('+')}, {{2}}},
+                          {E, {t('n')}, {t('n')}, {{0}}},
+                        },
+                        L};
+  GLRLA la;
+  RecoveringGLR glr(la, tg);
+
+  // errors in deterministic and generalized mode are both recovered from
+  CHECK(translate(glr, la, "i ; n + ; i ;") == "error");
+  CHECK(glr.recoveries == 1);
+  CHECK(translate(glr, la, "n + n + ; n + n + n ; n + n + ; i ;") == "error");
+  CHECK(glr.generalized_tokens() > 0);
+  CHECK(glr.recoveries == 3);
+}
+
+TEST_CASE("GLR non-LR grammars", "[GLRTranslationControl]") {
+  auto S = Nonterminal(0), A = Nonterminal(1), B = Nonterminal(2);
+
+  SECTION("unbounded lookahead") {
+    // S -> a S a | a; the middle of the input is not known until its end
+    TranslationGrammar tg{{
+                            {S, {t('a'), S, t('a')}, {t('('), S, t(')')}},
+                            {S, {t('a')}, {t('x')}},
+                          },
+                          S};
+    GLRLA la;
+    GLRTranslationControl glr(la, tg);
+    REQUIRE(glr.lr_table().unresolved_conflicts() > 0);
+    CHECK(translate(glr, la, "a") == "x");
+    CHECK(translate(glr, la, "a a a") == "(x)");
+    CHECK(translate(glr, la, "a a a a a a a") == "(((x)))");
+    CHECK(glr.ambiguities() == 0);
+    CHECK(translate(glr, la, "a a a a") == "error");
+  }
+  SECTION("common prefixes") {
+    // S -> a b | a b c is deterministic
+    TranslationGrammar tg{{
+                            {S, {t('a'), t('b')}},
+                            {S, {t('a'), t('b'), t('x')}},
+                          },
+                          S};
+    GLRLA la;
+    GLRTranslationControl glr(la, tg);
+    CHECK(glr.lr_table().unresolved_conflicts() == 0);
+    CHECK(translate(glr, la, "a b") == "ab");
+    CHECK(translate(glr, la, "a b x") == "abx");
+    CHECK(glr.generalized_tokens() == 0);
+  }
+  SECTION("R/R conflicts") {
+    // S -> A b is defined first
+    TranslationGrammar tg{{
+                            {S, {A, t('b')}},
+                            {S, {B, t('b')}},
+                            {B, {t('a')}, {t('x')}},
+                            {A, {t('a')}, {t('i')}},
+                          },
+                          S};
+    GLRLA la;
+    GLRTranslationControl glr(la, tg);
+    CHECK(translate(glr, la, "a b") == "ib");
+    CHECK(glr.ambiguities() == 1);
+  }
+  SECTION("hidden left recursion") {
+    // S -> A S b | x, A -> ; reductions of the empty rule create cycles in the stack
+    TranslationGrammar tg{{
+                            {S, {A, S, t('b')}, {t('('), A, S, t('b')}},
+                            {S, {t('x')}},
+                            {A, {}},
+                          },
+                          S};
+    GLRLA la;
+    LR1GLRTranslationControl glr(la, tg);
+    CHECK(translate(glr, la, "x") == "x");
+    CHECK(translate(glr, la, "x b b") == "((xbb");
+    CHECK(translate(glr, la, "x b b x") == "error");
+  }
+}
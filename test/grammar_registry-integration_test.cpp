@@ -0,0 +1,164 @@
+#include <catch.hpp>
+
+#include <atomic>
+#include <sstream>
+#include <thread>
+#include "../src/ctf_translation.hpp"
+
+using ctf::GrammarRegistry;
+using ctf::LexicalAnalyzer;
+using ctf::OutputGenerator;
+using ctf::Symbol;
+using ctf::Token;
+using ctf::Translation;
+using ctf::TranslationGrammar;
+using ctf::TranslationResult;
+using ctf::VersionedLRTranslationControl;
+
+using namespace ctf::literals;
+
+namespace {
+class GRLexicalAnalyzer : public LexicalAnalyzer {
+ public:
+  using LexicalAnalyzer::LexicalAnalyzer;
+
+  Token read_token() override {
+    int c = get();
+    while (c == ' ' || c == '\n') {
+      reset_location();
+      c = get();
+    }
+    switch (c) {
+      case 'a':
+        return token(0_t);
+      case 'b':
+        return token(1_t);
+      case std::char_traits<char>::eof():
+        return token_eof();
+      default:
+        fatal_error("unexpected character");
+    }
+  }
+};
+
+class GROutputGenerator : public OutputGenerator {
+ public:
+  using OutputGenerator::OutputGenerator;
+
+  void output(const ctf::tstack<Token>& tokens) override {
+    for (auto& t : tokens) {
+      if (t != Symbol::eof()) {
+        os() << (t.symbol() == 0_t ? 'a' : 'b');
+      }
+    }
+  }
+};
+
+// accepts "a"
+const TranslationGrammar first{{{0_nt, {0_t}}}, 0_nt};
+// accepts "a b"
+const TranslationGrammar second{{{0_nt, {0_t, 1_t}}}, 0_nt};
+
+using GRTranslation =
+  Translation<GRLexicalAnalyzer, GROutputGenerator, VersionedLRTranslationControl>;
+
+TranslationResult translate(GRTranslation& tr, const std::string& input) {
+  std::stringstream is(input);
+  std::stringstream os;
+  std::stringstream errors;
+  return tr.run(is, os, errors);
+}
+}  // namespace
+
+TEST_CASE("GrammarRegistry publishing", "[GrammarRegistry]") {
+  GrammarRegistry registry;
+  REQUIRE(registry.version() == 0);
+  REQUIRE(registry.current() == nullptr);
+
+  GRTranslation tr{
+    GRLexicalAnalyzer(), VersionedLRTranslationControl(registry), GROutputGenerator()};
+  // no grammar published yet
+  REQUIRE_THROWS_AS(translate(tr, "a"), ctf::TranslationException);
+
+  auto v1 = registry.publish(first);
+  REQUIRE(v1->number == 1);
+  REQUIRE(registry.version() == 1);
+  REQUIRE(registry.current() == v1);
+  CHECK(translate(tr, "a") == TranslationResult::SUCCESS);
+  CHECK(translate(tr, "a b") == TranslationResult::TRANSLATION_ERROR);
+  CHECK(tr.translation_control().version() == v1);
+
+  auto v2 = registry.publish_async<ctf::LALRTable>(second).get();
+  REQUIRE(v2->number == 2);
+  REQUIRE(registry.version() == 2);
+  CHECK(translate(tr, "a b") == TranslationResult::SUCCESS);
+  CHECK(translate(tr, "a") == TranslationResult::TRANSLATION_ERROR);
+  CHECK(tr.translation_control().version() == v2);
+
+  SECTION("saved tables") {
+    std::stringstream saved;
+    v1->table.save(saved);
+    auto v3 = registry.publish(first, saved);
+    REQUIRE(v3->number == 3);
+    CHECK(translate(tr, "a") == TranslationResult::SUCCESS);
+  }
+}
+
+TEST_CASE("GrammarRegistry running translations keep their version", "[GrammarRegistry]") {
+  GrammarRegistry registry;
+  auto v1 = registry.publish(first);
+
+  GRLexicalAnalyzer la;
+  ctf::InputReader reader;
+  std::stringstream errors;
+  la.set_reader(reader);
+  la.set_error_stream(errors);
+  VersionedLRTranslationControl control(registry);
+  control.set_lexical_analyzer(la);
+  control.set_error_stream(errors);
+
+  std::stringstream is("a");
+  reader.set_stream(is);
+  control.reset();
+  // published while the translation is running
+  registry.publish(second);
+  v1.reset();
+  REQUIRE(control.version()->number == 1);
+  control.run(reader);
+  CHECK_FALSE(control.error());
+
+  control.reset();
+  CHECK(control.version()->number == 2);
+}
+
+TEST_CASE("GrammarRegistry concurrent publishing", "[GrammarRegistry]") {
+  GrammarRegistry registry;
+  registry.publish(first);
+
+  std::atomic<bool> done{false};
+  std::atomic<std::size_t> mismatches{0};
+  std::atomic<std::size_t> translations{0};
+  auto worker = [&]() {
+    GRTranslation tr{
+      GRLexicalAnalyzer(), VersionedLRTranslationControl(registry), GROutputGenerator()};
+    while (!done || translations < 100) {
+      auto result = translate(tr, "a b");
+      // odd versions use the first grammar
+      bool accepted = tr.translation_control().version()->number % 2 == 0;
+      if ((result == TranslationResult::SUCCESS) != accepted) {
+        ++mismatches;
+      }
+      ++translations;
+    }
+  };
+  std::thread t1(worker);
+  std::thread t2(worker);
+  for (std::size_t i = 0; i < 20; ++i) {
+    registry.publish_async(i % 2 == 0 ? second : first).get();
+  }
+  done = true;
+  t1.join();
+  t2.join();
+  CHECK(registry.version() == 21);
+  CHECK(mismatches == 0);
+}
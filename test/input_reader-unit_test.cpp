@@ -87,4 +87,72 @@ TEST_CASE("Unget", "[InputReader]") {
   // {1,1}
   REQUIRE(char(r.get()) == 'a');
   // {1, 2}
-}
\ No newline at end of file
+}
+
+TEST_CASE("Peek and skip", "[InputReader]") {
+  std::stringstream s;
+  InputReader r{s};
+  s << "\t\t\tx\n  \ny\t";
+
+  REQUIRE(r.peek() == '\t');
+  REQUIRE(r.location() == Location(1, 1));
+  REQUIRE(r.skip('\t') == 3);
+  REQUIRE(r.location() == Location(1, 4));
+  REQUIRE(r.skip('\t') == 0);
+  REQUIRE(r.peek() == 'x');
+  REQUIRE(r.get() == 'x');
+  REQUIRE(r.get() == '\n');
+  REQUIRE(r.skip(' ') == 2);
+  REQUIRE(r.get() == '\n');
+  REQUIRE(r.get() == 'y');
+  REQUIRE(r.skip('\t') == 1);
+  REQUIRE(r.peek() == std::char_traits<char>::eof());
+  REQUIRE(r.location() == Location(3, 3));
+
+  // buffered characters
+  r.unget(50);
+  REQUIRE(r.skip('\t') == 3);
+  REQUIRE(r.location() == Location(1, 4));
+  REQUIRE(r.get() == 'x');
+}
+
+TEST_CASE("Skip buffers the rest of the line", "[InputReader]") {
+  std::stringstream s;
+  InputReader r{s};
+  s << "a\n    b c\nd";
+
+  REQUIRE(r.get() == 'a');
+  REQUIRE(r.get() == '\n');
+  // the next line is read from the stream at once and scanned in the buffer
+  REQUIRE(r.skip(' ') == 4);
+  CHECK(r.get_line(2) == "    b c\n");
+  CHECK(r.get_all() == "a\n    b c\n");
+  REQUIRE(r.location() == Location(2, 5));
+  REQUIRE(r.get() == 'b');
+  REQUIRE(r.skip(' ') == 1);
+  REQUIRE(r.get() == 'c');
+  REQUIRE(r.get() == '\n');
+  // the last line has no newline
+  REQUIRE(r.skip('d') == 1);
+  REQUIRE(r.get() == std::char_traits<char>::eof());
+  REQUIRE(r.location() == Location(3, 2));
+  CHECK(r.get_all() == "a\n    b c\nd");
+
+  SECTION("skipping in the middle of the last line") {
+    std::stringstream last;
+    last << "\tfoo  bar";
+    r.set_stream(last);
+    REQUIRE(r.skip('\t') == 1);
+    REQUIRE(r.get() == 'f');
+    REQUIRE(r.get() == 'o');
+    REQUIRE(r.get() == 'o');
+    REQUIRE(r.skip(' ') == 2);
+    CHECK(r.get_all() == "\tfoo  bar");
+    REQUIRE(r.get() == 'b');
+    REQUIRE(r.get() == 'a');
+    REQUIRE(r.get() == 'r');
+    REQUIRE(r.skip(' ') == 0);
+    REQUIRE(r.get() == std::char_traits<char>::eof());
+    CHECK(r.get_all() == "\tfoo  bar");
+  }
+}
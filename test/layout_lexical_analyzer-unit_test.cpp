@@ -0,0 +1,138 @@
+#include <catch.hpp>
+#include <sstream>
+
+#include "../src/ctf_layout_lexical_analyzer.hpp"
+
+using ctf::Indentation;
+using ctf::InputReader;
+using ctf::LayoutLexicalAnalyzer;
+using ctf::Location;
+using ctf::Symbol;
+using ctf::Token;
+using namespace ctf::literals;
+
+namespace {
+constexpr Symbol newline = 0_t;
+constexpr Symbol indent = 1_t;
+constexpr Symbol dedent = 2_t;
+constexpr Symbol word = 3_t;
+
+class LayoutLex : public LayoutLexicalAnalyzer {
+ public:
+  using LayoutLexicalAnalyzer::LayoutLexicalAnalyzer;
+
+  /**
+  \brief Close all indentation levels at the end of input.
+  */
+  bool closeLayout = false;
+
+ protected:
+  Token read_layout_token() override {
+    int c = get();
+    while (c == ' ' || c == '\t') {
+      reset_location();
+      c = get();
+    }
+    switch (c) {
+      case '\n':
+        return token_newline();
+      case std::char_traits<char>::eof():
+        return closeLayout ? token_layout_eof() : token_eof();
+      default:
+        return token(word);
+    }
+  }
+};
+
+ctf::vector<Symbol> symbols(LayoutLex& l) {
+  ctf::vector<Symbol> result;
+  for (Token t = l.get_token(); t != Symbol::eof(); t = l.get_token()) {
+    result.push_back(t.symbol());
+  }
+  return result;
+}
+}  // namespace
+
+TEST_CASE("LayoutLexicalAnalyzer tabs", "[LayoutLexicalAnalyzer]") {
+  std::stringstream s;
+  std::stringstream err;
+  InputReader r{s};
+  LayoutLex l{newline, indent, dedent};
+  l.set_reader(r);
+  l.set_error_stream(err);
+  s << "a\n\t\t\tb\n\tc\nd";
+
+  REQUIRE(symbols(l) == ctf::vector<Symbol>{word,
+                                            newline,
+                                            indent,
+                                            indent,
+                                            indent,
+                                            word,
+                                            newline,
+                                            dedent,
+                                            dedent,
+                                            word,
+                                            newline,
+                                            dedent,
+                                            word});
+  REQUIRE(l.level() == 0);
+  REQUIRE(err.str().empty());
+
+  SECTION("token locations") {
+    std::stringstream s2("a\n\tb");
+    r.set_stream(s2);
+    l.reset();
+    REQUIRE(l.get_token().location() == Location(1, 1));
+    REQUIRE(l.get_token().location() == Location(1, 2));
+    Token t = l.get_token();
+    REQUIRE(t == indent);
+    REQUIRE(t.location() == Location(2, 1));
+    REQUIRE(l.get_token().location() == Location(2, 2));
+  }
+  SECTION("spaces in tab indentation") {
+    std::stringstream s2("a\n\t b");
+    r.set_stream(s2);
+    l.reset();
+    symbols(l);
+    REQUIRE(err.str().find("Spaces are not allowed") != std::string::npos);
+  }
+}
+
+TEST_CASE("LayoutLexicalAnalyzer spaces", "[LayoutLexicalAnalyzer]") {
+  std::stringstream s;
+  std::stringstream err;
+  InputReader r{s};
+  LayoutLex l{newline, indent, dedent, Indentation::SPACES, 2};
+  l.set_reader(r);
+  l.set_error_stream(err);
+  l.closeLayout = true;
+  s << "a\n    b\n  c\n";
+
+  REQUIRE(symbols(l) == ctf::vector<Symbol>{word,
+                                            newline,
+                                            indent,
+                                            indent,
+                                            word,
+                                            newline,
+                                            dedent,
+                                            word,
+                                            newline,
+                                            dedent});
+  REQUIRE(err.str().empty());
+
+  SECTION("dedents at eof") {
+    std::stringstream s2("a\n      b");
+    r.set_stream(s2);
+    l.reset();
+    REQUIRE(symbols(l) == ctf::vector<Symbol>{
+                            word, newline, indent, indent, indent, word, dedent, dedent, dedent});
+    REQUIRE(l.get_token() == Symbol::eof());
+  }
+  SECTION("misaligned indentation") {
+    std::stringstream s2("a\n   b");
+    r.set_stream(s2);
+    l.reset();
+    REQUIRE(symbols(l) == ctf::vector<Symbol>{word, newline, indent, word, dedent});
+    REQUIRE(err.str().find("not a multiple of 2 spaces") != std::string::npos);
+  }
+}
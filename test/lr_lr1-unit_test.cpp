@@ -0,0 +1,44 @@
+#include <catch.hpp>
+
+#include "../src/ctf_lr_lr1.hpp"
+
+using ctf::Symbol;
+using ctf::lr1::LookaheadSet;
+using ctf::lr1::LookaheadSetPool;
+using namespace ctf::literals;
+
+TEST_CASE("LookaheadSetPool interning", "[lr1]") {
+  LookaheadSetPool pool(4);
+  REQUIRE(pool.size() == 1);
+  REQUIRE(pool[LookaheadSetPool::empty] == LookaheadSet(4));
+  REQUIRE(pool.intern(LookaheadSet(4)) == LookaheadSetPool::empty);
+
+  auto a = pool.intern(LookaheadSet(4, {0_t}));
+  auto b = pool.intern(LookaheadSet(4, {1_t, Symbol::eof()}));
+  CHECK(a != b);
+  CHECK(pool.intern(LookaheadSet(4, {0_t})) == a);
+  CHECK(pool.intern(LookaheadSet(4, {Symbol::eof(), 1_t})) == b);
+  CHECK(pool.size() == 3);
+  CHECK(pool[b] == LookaheadSet(4, {1_t, Symbol::eof()}));
+}
+
+TEST_CASE("LookaheadSetPool unions", "[lr1]") {
+  LookaheadSetPool pool(4);
+  auto a = pool.intern(LookaheadSet(4, {0_t}));
+  auto b = pool.intern(LookaheadSet(4, {1_t}));
+  auto ab = pool.intern(LookaheadSet(4, {0_t, 1_t}));
+
+  CHECK(pool.set_union(a, LookaheadSetPool::empty) == a);
+  CHECK(pool.set_union(LookaheadSetPool::empty, b) == b);
+  CHECK(pool.set_union(a, a) == a);
+  CHECK(pool.set_union(a, ab) == ab);
+  CHECK(pool.size() == 4);
+
+  auto c = pool.intern(LookaheadSet(4, {2_t}));
+  auto bc = pool.set_union(b, c);
+  CHECK(pool[bc] == LookaheadSet(4, {1_t, 2_t}));
+  CHECK(pool.size() == 6);
+  // memoized in both operand orders
+  CHECK(pool.set_union(c, b) == bc);
+  CHECK(pool.size() == 6);
+}
@@ -59,3 +59,135 @@ TEST_CASE("LALRTable base", "[LALRTable]") {
   state = table.lr_goto(0, "S"_nt);
   REQUIRE(table.lr_action(state, Symbol::eof()).action() == LRAction::SUCCESS);
 }
+
+TEST_CASE("LRAutoTable algorithm selection", "[LRAutoTable]") {
+  using ctf::LRAlgorithm;
+  using ctf::LRAutoTable;
+  using ctf::Nonterminal;
+  using ctf::Terminal;
+
+  SECTION("LALR grammar") {
+    LRAutoTable table{grammar};
+    LALRTable lalr{grammar};
+    REQUIRE(table.algorithm() == LRAlgorithm::LALR);
+    REQUIRE(table.unresolved_conflicts() == 0);
+    REQUIRE(table.states() == lalr.states());
+    REQUIRE(table.size() == lalr.size());
+  }
+  SECTION("LR(1) grammar that is not LALR") {
+    auto S = Nonterminal(0), A = Nonterminal(1), B = Nonterminal(2);
+    auto a = Terminal(0), b = Terminal(1), c = Terminal(2), d = Terminal(3), e = Terminal(4);
+    TranslationGrammar lr1Grammar{{
+                                    {S, {a, A, d}},
+                                    {S, {b, B, d}},
+                                    {S, {a, B, e}},
+                                    {S, {b, A, e}},
+                                    {A, {c}},
+                                    {B, {c}},
+                                  },
+                                  S};
+    REQUIRE(LALRTable(lr1Grammar).unresolved_conflicts() > 0);
+
+    LRAutoTable table{lr1Grammar};
+    REQUIRE(table.algorithm() != LRAlgorithm::LALR);
+    REQUIRE(table.unresolved_conflicts() == 0);
+    REQUIRE(table.size() > 0);
+  }
+  SECTION("Ambiguous grammar") {
+    auto S = Nonterminal(0), A = Nonterminal(1), B = Nonterminal(2);
+    auto c = Terminal(0);
+    TranslationGrammar ambiguous{{
+                                   {S, {A}},
+                                   {S, {B}},
+                                   {A, {c}},
+                                   {B, {c}},
+                                 },
+                                 S};
+    LRAutoTable table{ambiguous};
+    REQUIRE(table.algorithm() == LRAlgorithm::LR1);
+    REQUIRE(table.unresolved_conflicts() > 0);
+  }
+}
+
+TEST_CASE("GLR tables keep conflicts", "[GLRGenericTable]") {
+  using ctf::Associativity;
+  using ctf::LALRGLRTable;
+  using ctf::LRActionItem;
+  using ctf::Nonterminal;
+  using ctf::PrecedenceSet;
+  using ctf::Terminal;
+
+  SECTION("LALR grammar") {
+    LALRGLRTable table{grammar};
+    LALRTable lalr{grammar};
+    REQUIRE(table.unresolved_conflicts() == 0);
+    REQUIRE(table.states() == lalr.states());
+    REQUIRE(table.size() == lalr.size());
+    for (size_t state = 0; state < table.states(); ++state) {
+      CHECK_FALSE(table.conflicted(state));
+      for (auto terminal : {"i"_t, "o"_t, "("_t, ")"_t, Symbol::eof()}) {
+        CHECK(table.lr_action(state, terminal) == lalr.lr_action(state, terminal));
+      }
+    }
+  }
+  SECTION("Ambiguous grammar") {
+    auto E = Nonterminal(0);
+    auto plus = Terminal(0), times = Terminal(1), n = Terminal(2);
+    ctf::vector<TranslationGrammar::Rule> rules{
+      {E, {E, plus, E}},
+      {E, {E, times, E}},
+      {E, {n}},
+    };
+    LALRGLRTable ambiguous{{rules, E}};
+    // E + E . + and E + E . * are conflicting, as are the same cells for *
+    REQUIRE(ambiguous.unresolved_conflicts() == 4);
+    // E + E .
+    std::size_t state = ambiguous.lr_goto(0, E);
+    state = ambiguous.lr_action(state, plus).argument();
+    state = ambiguous.lr_goto(state, E);
+    REQUIRE(ambiguous.conflicted(state));
+    // the shift is the primary action
+    CHECK(ambiguous.lr_action(state, plus).action() == LRAction::SHIFT);
+    auto conflicts = ambiguous.lr_conflicts(state, plus);
+    REQUIRE(conflicts.size() == 1);
+    CHECK(*conflicts.begin() == LRActionItem(LRAction::REDUCE, 0));
+    CHECK(ambiguous.lr_conflicts(state, Symbol::eof()).empty());
+
+    // precedences resolve all conflicts
+    LALRGLRTable resolved{{rules,
+                           E,
+                           {
+                             {Associativity::LEFT, {times}},
+                             {Associativity::LEFT, {plus}},
+                           }}};
+    CHECK(resolved.unresolved_conflicts() == 0);
+  }
+  SECTION("Common prefixes") {
+    auto S = Nonterminal(0);
+    auto a = Terminal(0), b = Terminal(1), c = Terminal(2), x = Terminal(3);
+    // both items shift b into the same state
+    LALRGLRTable prefixes{{{
+                             {S, {a, b}},
+                             {S, {a, b, c}},
+                           },
+                           S}};
+    CHECK(prefixes.unresolved_conflicts() == 0);
+    for (size_t state = 0; state < prefixes.states(); ++state) {
+      CHECK_FALSE(prefixes.conflicted(state));
+    }
+
+    // the shift must not be mistaken for a reduction when resolving precedence
+    LALRGLRTable precedence{{{
+                               {S, {x, x, x, x, a, b}},
+                               {S, {x, x, x, x, a, b, c}},
+                             },
+                             S,
+                             {{Associativity::LEFT, {b}}}}};
+    CHECK(precedence.unresolved_conflicts() == 0);
+  }
+  SECTION("Default constructed table") {
+    LALRGLRTable empty;
+    CHECK_FALSE(empty.conflicted(0));
+    CHECK(empty.lr_conflicts(0, Symbol::eof()).empty());
+  }
+}
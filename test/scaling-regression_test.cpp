@@ -0,0 +1,392 @@
+#include <catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include "../src/ctf_translation.hpp"
+
+using ctf::Attribute;
+using ctf::LexicalAnalyzer;
+using ctf::Nonterminal;
+using ctf::OutputGenerator;
+using ctf::Rule;
+using ctf::string;
+using ctf::Symbol;
+using ctf::Terminal;
+using ctf::Token;
+using ctf::TranslationGrammar;
+using ctf::vector;
+
+/*
+Scaling and allocation regression tests.
+
+Every workload is run at geometrically increasing sizes. The growth exponent is the slope of the
+least squares fit in log-log space; it must not exceed the bound declared for the workload.
+Allocation counts are deterministic and get tight bounds. They only catch regressions that
+allocate: superlinear work that does not allocate, such as a linear search in
+tstack::replace_last or InputBuffer::unget, is only caught by the running times. Running times are
+noisy and get loose bounds that still separate linear from quadratic behavior; they depend on the
+load of the machine, so their test case is hidden and only runs when selected, e.g. by
+./ctf_test "[scaling]".
+*/
+
+// interposed allocator counting all allocations of the test binary
+static std::atomic<std::size_t> allocations{0};
+
+void* operator new(std::size_t size) {
+  ++allocations;
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+/**
+\brief The cost of a single run of a workload.
+*/
+struct Cost {
+  double seconds;
+  std::size_t allocations;
+};
+
+/**
+\brief Runs f several times and returns the fastest run. Allocations are taken from the last run.
+*/
+template <typename F>
+Cost measure(F&& f, std::size_t repetitions = 3) {
+  Cost best{std::numeric_limits<double>::max(), 0};
+  for (std::size_t i = 0; i < repetitions; ++i) {
+    std::size_t before = allocations;
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    best.allocations = allocations - before;
+    best.seconds = std::min(best.seconds, std::chrono::duration<double>(end - start).count());
+  }
+  return best;
+}
+
+/**
+\brief Fits y = c * n^k and returns k.
+*/
+double growth_exponent(const vector<double>& n, const vector<double>& y) {
+  double sx = 0, sy = 0, sxx = 0, sxy = 0;
+  for (std::size_t i = 0; i < n.size(); ++i) {
+    double x = std::log(n[i]);
+    double v = std::log(std::max(y[i], 1e-9));
+    sx += x;
+    sy += v;
+    sxx += x * x;
+    sxy += x * v;
+  }
+  double count = static_cast<double>(n.size());
+  return (count * sxy - sx * sy) / (count * sxx - sx * sx);
+}
+
+/**
+\brief The measured costs of a workload at all sizes.
+*/
+struct Scaling {
+  vector<double> sizes;
+  vector<double> seconds;
+  vector<double> allocations;
+
+  double time_exponent() const { return growth_exponent(sizes, seconds); }
+  double allocation_exponent() const { return growth_exponent(sizes, allocations); }
+  double allocations_per_unit() const { return allocations.back() / sizes.back(); }
+};
+
+/**
+\brief Runs workload(n) for n = first, first * 2, ... for the given number of sizes.
+*/
+template <typename F>
+Scaling scale(std::size_t first, std::size_t steps, F&& workload) {
+  Scaling result;
+  for (std::size_t i = 0, n = first; i < steps; ++i, n *= 2) {
+    auto cost = measure([&]() { workload(n); });
+    result.sizes.push_back(static_cast<double>(n));
+    result.seconds.push_back(cost.seconds);
+    result.allocations.push_back(static_cast<double>(cost.allocations));
+  }
+  return result;
+}
+
+// expression grammar with left recursion
+constexpr Symbol E = Nonterminal(0);
+constexpr Symbol T = Nonterminal(1);
+constexpr Symbol F = Nonterminal(2);
+constexpr Symbol L = Nonterminal(3);
+constexpr Symbol i = Terminal(0);
+constexpr Symbol plus = Terminal(1);
+constexpr Symbol times = Terminal(2);
+constexpr Symbol lpar = Terminal(3);
+constexpr Symbol rpar = Terminal(4);
+constexpr Symbol comma = Terminal(5);
+
+const TranslationGrammar expressions{{
+                                       {E, {E, plus, T}, {E, T, plus}, {{2}}},
+                                       {E, {T}},
+                                       {T, {T, times, F}, {T, F, times}, {{2}}},
+                                       {T, {F}},
+                                       {F, {lpar, E, rpar}, {E}, {{}, {}}},
+                                       {F, {i}},
+                                     },
+                                     E};
+
+// right recursive list
+const TranslationGrammar list{{
+                                {L, {i, comma, L}, {L, i}, {{1}, {}}},
+                                {L, {i}},
+                              },
+                              L};
+
+class ScalingLexicalAnalyzer : public LexicalAnalyzer {
+ public:
+  using LexicalAnalyzer::LexicalAnalyzer;
+
+  Token read_token() override {
+    int c = get();
+    while (c == ' ' || c == '\n') {
+      reset_location();
+      c = get();
+    }
+    switch (c) {
+      case 'i':
+        return token(i, Attribute(_count++));
+      case '+':
+        return token(plus);
+      case '*':
+        return token(times);
+      case '(':
+        return token(lpar);
+      case ')':
+        return token(rpar);
+      case ',':
+        return token(comma);
+      default:
+        return token_eof();
+    }
+  }
+
+  void reset_private() override { _count = 0; }
+
+ private:
+  std::size_t _count = 0;
+};
+
+class ScalingOutputGenerator : public OutputGenerator {
+ public:
+  using OutputGenerator::OutputGenerator;
+
+  void output(const ctf::tstack<Token>& tokens) override {
+    std::size_t sum = 0;
+    for (auto& t : tokens) {
+      if (t.symbol() == i) {
+        sum += t.attribute().get<std::size_t>();
+      }
+    }
+    os() << sum;
+  }
+};
+
+// n operands joined by alternating operators
+string flat_expression(std::size_t n) {
+  string s = "i";
+  for (std::size_t k = 1; k < n; ++k) {
+    s += (k % 2) ? " + i" : " * i";
+    if (k % 16 == 0) {
+      s += '\n';
+    }
+  }
+  return s;
+}
+
+// a single operand nested in n parentheses
+string nested_expression(std::size_t n) { return string(n, '(') + "i" + string(n, ')'); }
+
+// n list items
+string list_input(std::size_t n) {
+  string s = "i";
+  for (std::size_t k = 1; k < n; ++k) {
+    s += ",i";
+  }
+  return s;
+}
+
+/**
+\brief Expression grammar with n precedence levels: E_k -> E_k op_k E_k+1 | E_k+1.
+*/
+TranslationGrammar precedence_levels(std::size_t n) {
+  vector<Rule> rules;
+  Symbol operand = Terminal(0);
+  Symbol open = Terminal(1);
+  Symbol close = Terminal(2);
+  for (std::size_t k = 0; k < n; ++k) {
+    rules.push_back({Nonterminal(k), {Nonterminal(k), Terminal(k + 3), Nonterminal(k + 1)}});
+    rules.push_back({Nonterminal(k), {Nonterminal(k + 1)}});
+  }
+  rules.push_back({Nonterminal(n), {open, Nonterminal(0), close}});
+  rules.push_back({Nonterminal(n), {operand}});
+  return TranslationGrammar(std::move(rules), Nonterminal(0));
+}
+
+/**
+\brief Allocations of the phases of a translation.
+*/
+struct PhaseCosts {
+  std::size_t lexing = 0;
+  std::size_t parsing = 0;
+  std::size_t output = 0;
+};
+
+/**
+\brief Runs lexical analysis, syntax analysis and output generation, counted separately.
+*/
+template <typename Control>
+PhaseCosts phase_allocations(const TranslationGrammar& grammar, const string& input) {
+  PhaseCosts costs;
+  ScalingLexicalAnalyzer la;
+  ctf::InputReader reader;
+  std::stringstream errors;
+  la.set_reader(reader);
+  la.set_error_stream(errors);
+  {
+    std::stringstream is(input);
+    reader.set_stream(is);
+    costs.lexing = measure(
+                     [&]() {
+                       while (la.get_token() != Symbol::eof()) {
+                       }
+                     },
+                     1)
+                     .allocations;
+  }
+  Control control;
+  control.set_lexical_analyzer(la);
+  control.set_grammar(grammar);
+  control.set_error_stream(errors);
+  std::stringstream is(input);
+  la.reset();
+  reader.set_stream(is);
+  std::size_t lexingAndParsing = measure([&]() { control.run(reader); }, 1).allocations;
+  costs.parsing = lexingAndParsing - std::min(lexingAndParsing, costs.lexing);
+  REQUIRE_FALSE(control.error());
+
+  std::stringstream os;
+  ScalingOutputGenerator og(os);
+  og.set_error_stream(errors);
+  costs.output = measure([&]() { og.output(control.output()); }, 1).allocations;
+  return costs;
+}
+
+template <typename Control>
+void translate(const TranslationGrammar& grammar, const string& input) {
+  ctf::Translation tr(ScalingLexicalAnalyzer(), Control(), grammar, ScalingOutputGenerator());
+  std::stringstream is(input);
+  std::stringstream os;
+  std::stringstream errors;
+  REQUIRE(tr.run(is, os, errors) == ctf::TranslationResult::SUCCESS);
+}
+
+void translate_flat(std::size_t n) { translate<ctf::LALR>(expressions, flat_expression(n)); }
+
+void translate_nested(std::size_t n) { translate<ctf::LALR>(expressions, nested_expression(n)); }
+
+void translate_list(std::size_t n) { translate<ctf::LALR>(list, list_input(n)); }
+
+/**
+\brief Reads n characters, then steps back and rereads them one character at a time.
+*/
+void reread_input(std::size_t n) {
+  string input;
+  for (std::size_t k = 0; k < n; ++k) {
+    input += (k % 8 == 7) ? '\n' : 'x';
+  }
+  std::stringstream is(input);
+  ctf::InputReader reader(is);
+  while (reader.get() != std::char_traits<char>::eof()) {
+  }
+  reader.unget(n + 1);
+  for (std::size_t k = 0; k < n; ++k) {
+    reader.get();
+    reader.get();
+    reader.unget();
+  }
+}
+
+template <typename LRTableType>
+void construct_table(std::size_t n) {
+  LRTableType table(precedence_levels(n));
+}
+
+}  // namespace
+
+TEST_CASE("Translation allocations scale linearly with input length", "[scaling]") {
+  SECTION("flat expressions") {
+    CHECK(scale(1024, 5, translate_flat).allocation_exponent() <= 1.05);
+  }
+  SECTION("nested expressions") {
+    CHECK(scale(512, 5, translate_nested).allocation_exponent() <= 1.05);
+  }
+  SECTION("right recursive lists") {
+    CHECK(scale(1024, 5, translate_list).allocation_exponent() <= 1.05);
+  }
+}
+
+TEST_CASE("Input reader allocations scale linearly with rereads", "[scaling]") {
+  CHECK(scale(4096, 5, reread_input).allocation_exponent() <= 1.05);
+}
+
+TEST_CASE("LR table construction allocations scale with grammar size", "[scaling]") {
+  // declared bounds in the number of precedence levels
+  SECTION("LALR") {
+    CHECK(scale(4, 4, construct_table<ctf::LALRTable>).allocation_exponent() <= 2.1);
+  }
+  SECTION("LSCELR") {
+    CHECK(scale(4, 4, construct_table<ctf::LSCELRTable>).allocation_exponent() <= 2.5);
+  }
+  SECTION("Canonical LR(1)") {
+    CHECK(scale(4, 4, construct_table<ctf::LR1Table>).allocation_exponent() <= 2.1);
+  }
+}
+
+TEST_CASE("Running times scale with input and grammar size", "[.scaling]") {
+  SECTION("flat expressions") { CHECK(scale(1024, 5, translate_flat).time_exponent() <= 1.4); }
+  SECTION("nested expressions") {
+    CHECK(scale(512, 5, translate_nested).time_exponent() <= 1.4);
+  }
+  SECTION("right recursive lists") {
+    CHECK(scale(1024, 5, translate_list).time_exponent() <= 1.4);
+  }
+  SECTION("input reader unget") { CHECK(scale(4096, 5, reread_input).time_exponent() <= 1.4); }
+  SECTION("LALR table construction") {
+    CHECK(scale(4, 4, construct_table<ctf::LALRTable>).time_exponent() <= 2.5);
+  }
+  SECTION("LSCELR table construction") {
+    CHECK(scale(4, 4, construct_table<ctf::LSCELRTable>).time_exponent() <= 2.9);
+  }
+  SECTION("Canonical LR(1) table construction") {
+    CHECK(scale(4, 4, construct_table<ctf::LR1Table>).time_exponent() <= 2.5);
+  }
+}
+
+TEST_CASE("Allocations per input token stay within budget", "[scaling]") {
+  const std::size_t n = 4096;
+  auto costs = phase_allocations<ctf::LALR>(expressions, flat_expression(n));
+  // operands and operators
+  const double tokens = 2.0 * n;
+  // small attributes are stored without allocation
+  CHECK(costs.lexing / tokens <= 0.1);
+  // token buffer, pushdown and the input and output tstack nodes
+  CHECK(costs.parsing / tokens <= 8.0);
+  CHECK(costs.output / tokens <= 0.1);
+}
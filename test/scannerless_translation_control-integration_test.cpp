@@ -0,0 +1,126 @@
+#include <catch.hpp>
+
+#include <sstream>
+#include "../src/ctf_scannerless_translation_control.hpp"
+
+using ctf::InputReader;
+using ctf::LexemeKind;
+using ctf::Location;
+using ctf::LR1ScannerlessTranslationControl;
+using ctf::ScannerlessLexicalAnalyzer;
+using ctf::ScannerlessTranslationControl;
+using ctf::string;
+using ctf::Symbol;
+using ctf::TranslationGrammar;
+using namespace ctf::literals;
+
+namespace {
+constexpr Symbol kwIf = 0_t;
+constexpr Symbol identifier = 1_t;
+constexpr Symbol assign = 2_t;
+constexpr Symbol semicolon = 3_t;
+
+/**
+\brief Statements "if x;" and "x = y;". The keyword is listed before identifiers, so it is
+preferred wherever both are valid.
+*/
+ScannerlessLexicalAnalyzer make_lexer() {
+  return ScannerlessLexicalAnalyzer({
+    {"if", kwIf},
+    {"[a-z]+", identifier},
+    {"=", assign},
+    {";", semicolon},
+    {"[ \\n]+", Symbol::eof(), LexemeKind::SKIP},
+  });
+}
+
+TranslationGrammar make_grammar() {
+  constexpr Symbol L = 0_nt;
+  constexpr Symbol S = 1_nt;
+  return TranslationGrammar{
+    {
+      {L, {L, S}},
+      {L, {S}},
+      {S, {kwIf, identifier, semicolon}, {kwIf, identifier}, {{0}, {1}, {}}},
+      {S,
+       {identifier, assign, identifier, semicolon},
+       {assign, identifier, identifier},
+       {{1}, {0}, {2}, {}}},
+    },
+    L,
+  };
+}
+
+/**
+\brief Translates the input and returns the lexemes of the output.
+*/
+template <typename Control>
+string translate(Control& control, ScannerlessLexicalAnalyzer& la, const string& input) {
+  std::stringstream in(input);
+  std::stringstream err;
+  InputReader r{in};
+  la.set_reader(r);
+  la.reset();
+  la.set_error_stream(err);
+  control.reset();
+  control.set_error_stream(err);
+  control.set_lexical_analyzer(la);
+  control.run(r);
+  if (control.error()) {
+    return "error";
+  }
+  string output;
+  for (auto& token : control.output()) {
+    if (token != Symbol::eof()) {
+      output += string(token.attribute().template get<std::string_view>()) + " ";
+    }
+  }
+  return output;
+}
+}  // namespace
+
+TEST_CASE("Scannerless keywords in context", "[ScannerlessTranslationControl]") {
+  auto la = make_lexer();
+  auto grammar = make_grammar();
+  ScannerlessTranslationControl control(la, grammar);
+
+  CHECK(translate(control, la, "if x;") == "if x ");
+  // only identifiers are valid after "if" and "="
+  CHECK(translate(control, la, "if if;") == "if if ");
+  CHECK(translate(control, la, "x = if; y = x;") == "= x if = y x ");
+  // at the start of a statement, the keyword is preferred
+  CHECK(translate(control, la, "if = y;") == "error");
+  // the longest match is still preferred within a context
+  CHECK(translate(control, la, "ifx = y;") == "= ifx y ");
+  // the contexts of all reached states have been constructed and are shared
+  auto contexts = la.contexts();
+  CHECK(contexts > 1);
+  CHECK(translate(control, la, "x = if; if if; ifx = y;") == "= x if if if = ifx y ");
+  CHECK(la.contexts() == contexts);
+}
+
+TEST_CASE("Scannerless errors", "[ScannerlessTranslationControl]") {
+  auto la = make_lexer();
+  auto grammar = make_grammar();
+  LR1ScannerlessTranslationControl control(la, grammar);
+
+  // terminals that are not valid in a state are reported by the parser
+  CHECK(translate(control, la, "x = ;") == "error");
+  CHECK(translate(control, la, "x = y") == "error");
+  CHECK_THROWS_AS(translate(control, la, "x = $;"), ctf::LexicalException);
+  CHECK(la.error());
+
+  SECTION("locations") {
+    std::stringstream in("x\n  = if ;");
+    InputReader r{in, "file"};
+    la.set_reader(r);
+    la.reset();
+    control.reset();
+    control.run(r);
+    REQUIRE_FALSE(control.error());
+    auto it = control.output().begin();
+    CHECK(it->location() == Location{2, 3, "file"});
+    CHECK((++it)->location() == Location{1, 1, "file"});
+    CHECK((++it)->location() == Location{2, 5, "file"});
+  }
+}
@@ -0,0 +1,127 @@
+#include <catch.hpp>
+
+#include <sstream>
+#include "../src/ctf_segmented_output_generator.hpp"
+
+using ctf::SegmentedOutputGenerator;
+using ctf::Token;
+using ctf::Attribute;
+using ctf::tstack;
+
+using namespace ctf::literals;
+
+class TestSegmentedOutput : public SegmentedOutputGenerator {
+ public:
+  using SegmentedOutputGenerator::SegmentedOutputGenerator;
+
+ protected:
+  void output_segment(Segment& segment) override {
+    auto& os = segment.os();
+    os << segment.index() << ":";
+    for (auto it = segment.begin(); it != segment.end(); ++it) {
+      if (it->symbol() == 2_t) {
+        segment.error(it, "invalid token in segment " + std::to_string(segment.index()));
+      } else if (it->symbol() == 3_t) {
+        segment.fatal_error("fatal error in segment " + std::to_string(segment.index()));
+      }
+      os << " " << it->symbol().to_string();
+    }
+    os << "\n";
+  }
+};
+
+TEST_CASE("SegmentedOutputGenerator segments", "[SegmentedOutputGenerator]") {
+  std::stringstream out;
+  std::stringstream err;
+  TestSegmentedOutput o{out, 0_t, 4};
+  o.set_error_stream(err);
+
+  SECTION("no markers") {
+    o.output({1_t, 1_t, ctf::Symbol::eof()});
+    REQUIRE(out.str() == "0: 1_t 1_t EOF\n");
+  }
+  SECTION("leading marker") {
+    o.output({0_t, 1_t, 0_t, 0_t, 1_t, ctf::Symbol::eof()});
+    REQUIRE(out.str() == "0: 0_t 1_t\n1: 0_t\n2: 0_t 1_t EOF\n");
+    REQUIRE(err.str() == "");
+    REQUIRE(!o.error());
+  }
+  SECTION("empty output") {
+    o.output({});
+    REQUIRE(out.str() == "0:\n");
+  }
+}
+
+TEST_CASE("SegmentedOutputGenerator ordering", "[SegmentedOutputGenerator]") {
+  std::stringstream out;
+  std::stringstream expected;
+  std::stringstream err;
+  TestSegmentedOutput o{out, 0_t, 8};
+  o.set_error_stream(err);
+
+  tstack<Token> tokens;
+  for (std::size_t i = 0; i < 1000; ++i) {
+    expected << i << ": 0_t 1_t 1_t\n";
+  }
+  // the first pushed tokens end up at the bottom of the tstack
+  for (std::size_t i = 0; i < 1000; ++i) {
+    tokens.push(1_t);
+    tokens.push(1_t);
+    tokens.push(0_t);
+  }
+  o.output(tokens);
+  REQUIRE(out.str() == expected.str());
+}
+
+TEST_CASE("SegmentedOutputGenerator errors", "[SegmentedOutputGenerator]") {
+  std::stringstream out;
+  std::stringstream err;
+  TestSegmentedOutput o{out, 0_t, 4};
+  o.set_error_stream(err);
+
+  SECTION("errors in order") {
+    o.output({Token(0_t), Token(2_t, Attribute{}, {1, 1, "f"}), 0_t, 1_t, 0_t,
+              Token(2_t, Attribute{}, {3, 1, "f"})});
+    REQUIRE(o.error());
+    auto first = err.str().find("invalid token in segment 0");
+    auto second = err.str().find("invalid token in segment 2");
+    REQUIRE(first != std::string::npos);
+    REQUIRE(second != std::string::npos);
+    REQUIRE(first < second);
+    REQUIRE(err.str().find("f:1:1") < first);
+  }
+  SECTION("fatal error") {
+    REQUIRE_THROWS_AS(o.output({0_t, 2_t, 0_t, 3_t, 0_t, 2_t}), ctf::SemanticException);
+    REQUIRE(out.str() == "0: 0_t 2_t\n1: 0_t");
+    REQUIRE(err.str().find("segment 0") != std::string::npos);
+    REQUIRE(err.str().find("fatal error in segment 1") != std::string::npos);
+    REQUIRE(err.str().find("segment 2") == std::string::npos);
+  }
+}
+
+TEST_CASE("SegmentedOutputGenerator recorded diagnostics", "[SegmentedOutputGenerator]") {
+  class TextOutput : public SegmentedOutputGenerator {
+   public:
+    using SegmentedOutputGenerator::SegmentedOutputGenerator;
+
+   protected:
+    void output_segment(Segment& segment) override {
+      segment.err() << "before " << segment.index() << "\n";
+      segment.error("error " + std::to_string(segment.index()));
+      segment.err() << "after " << segment.index() << "\n";
+    }
+  };
+  std::stringstream out;
+  std::stringstream err;
+  ctf::DiagnosticSink sink;
+  TextOutput o{out, 0_t, 4};
+  o.set_error_stream(err);
+  o.set_diagnostics(sink);
+
+  o.output({0_t, 0_t});
+  // text written directly to the error buffers stays in order with the diagnostics
+  REQUIRE(err.str() == "");
+  REQUIRE(sink.errors() == 2);
+  REQUIRE(sink.to_string(ctf::DiagnosticFormat::PLAIN) ==
+          "before 0\nERROR:\nerror 0\nafter 0\nbefore 1\nERROR:\nerror 1\nafter 1\n");
+}
@@ -170,6 +170,31 @@ TEST_CASE("Running LR translation", "[Translation]") {
     REQUIRE(tr.run(in, out, error) == TranslationResult::SUCCESS);
     REQUIRE(out.str() == expected.str());
   }
+  SECTION("full translation with automatic table selection") {
+    TranslationGrammar tg{{
+                            {"E"_nt, {"T"_nt, "E'"_nt}},
+                            {"E'"_nt, {}},
+                            {"E'"_nt, {"+"_t, "T"_nt, "E'"_nt}, {"T"_nt, "+"_t, "E'"_nt}},
+                            {"F"_nt, {"("_t, "E"_nt, ")"_t}, {"E"_nt}},
+                            {"F"_nt, {"i"_t}},
+                            {"T"_nt, {"F"_nt, "T'"_nt}},
+                            {"T'"_nt, {}},
+                            {"T'"_nt, {"*"_t, "F"_nt, "T'"_nt}, {"F"_nt, "*"_t, "T'"_nt}},
+                          },
+                          "E"_nt};
+    Translation tr(TestLexicalAnalyzer(), ctf::Auto(), tg, TITOG());
+    REQUIRE(tr.translation_control().lr_table().algorithm() == ctf::LRAlgorithm::LALR);
+    std::stringstream expected;
+    std::stringstream out;
+    std::stringstream error;
+    std::ifstream in("media/in");
+    std::ifstream ex("media/expected");
+    if (in.fail() || ex.fail())
+      throw std::runtime_error("Files not present");
+    expected << ex.rdbuf();
+    REQUIRE(tr.run(in, out, error) == TranslationResult::SUCCESS);
+    REQUIRE(out.str() == expected.str());
+  }
   SECTION("translation with empty output") {
     TranslationGrammar tg{{
                             {"E"_nt, {"T"_nt, "E'"_nt}},
@@ -191,4 +216,70 @@ TEST_CASE("Running LR translation", "[Translation]") {
     REQUIRE(tr.run(in, out, error) == TranslationResult::SUCCESS);
     REQUIRE(out.str() == "");
   }
+  SECTION("syntax error diagnostics") {
+    TranslationGrammar tg{{
+                            {"E"_nt, {"T"_nt, "E'"_nt}},
+                            {"E'"_nt, {}},
+                            {"E'"_nt, {"+"_t, "T"_nt, "E'"_nt}, {"T"_nt, "+"_t, "E'"_nt}},
+                            {"F"_nt, {"("_t, "E"_nt, ")"_t}, {"E"_nt}},
+                            {"F"_nt, {"i"_t}},
+                            {"T"_nt, {"F"_nt, "T'"_nt}},
+                            {"T'"_nt, {}},
+                            {"T'"_nt, {"*"_t, "F"_nt, "T'"_nt}, {"F"_nt, "*"_t, "T'"_nt}},
+                          },
+                          "E"_nt};
+    Translation tr(TestLexicalAnalyzer(), tg, TITOG());
+    std::stringstream out;
+    std::stringstream error;
+
+    std::stringstream in("i + + i");
+    REQUIRE(tr.run(in, out, error, "in") == TranslationResult::TRANSLATION_ERROR);
+    REQUIRE(tr.diagnostics().errors() == 1);
+    REQUIRE(error.str().find("in:1:5: ") == 0);
+
+    tr.set_diagnostic_format(ctf::DiagnosticFormat::JSON);
+    std::stringstream in2("i + + i");
+    std::stringstream error2;
+    REQUIRE(tr.run(in2, out, error2, "in") == TranslationResult::TRANSLATION_ERROR);
+    REQUIRE(tr.diagnostics().errors() == 1);
+    REQUIRE(error2.str().find(
+              "[\n  {\"severity\": \"error\", \"source\": \"in\", \"row\": 1, \"col\": 5, ") == 0);
+  }
+  SECTION("diagnostics are rendered when the translation throws") {
+    TranslationGrammar tg{{
+                            {"E"_nt, {"T"_nt, "E'"_nt}},
+                            {"E'"_nt, {}},
+                            {"E'"_nt, {"+"_t, "T"_nt, "E'"_nt}, {"T"_nt, "+"_t, "E'"_nt}},
+                            {"F"_nt, {"("_t, "E"_nt, ")"_t}, {"E"_nt}},
+                            {"F"_nt, {"i"_t}},
+                            {"T"_nt, {"F"_nt, "T'"_nt}},
+                            {"T'"_nt, {}},
+                            {"T'"_nt, {"*"_t, "F"_nt, "T'"_nt}, {"F"_nt, "*"_t, "T'"_nt}},
+                          },
+                          "E"_nt};
+    class ThrowingLexicalAnalyzer : public TestLexicalAnalyzer {
+     public:
+      using TestLexicalAnalyzer::TestLexicalAnalyzer;
+
+      Token read_token() override {
+        auto token = TestLexicalAnalyzer::read_token();
+        if (token == "+"_t) {
+          warning("recorded warning");
+          err() << "direct message\n";
+          throw std::runtime_error("unexpected operator");
+        }
+        return token;
+      }
+    };
+    Translation tr(ThrowingLexicalAnalyzer(), tg, TITOG());
+    std::stringstream out;
+    std::stringstream error;
+
+    std::stringstream in("i + i");
+    REQUIRE_THROWS_AS(tr.run(in, out, error, "in"), std::runtime_error);
+    REQUIRE(tr.diagnostics().warnings() == 1);
+    // the direct message is written after the recorded warning
+    REQUIRE(error.str().find("in:1:3: ") == 0);
+    REQUIRE(error.str().find("recorded warning\ndirect message\n") != string::npos);
+  }
 }
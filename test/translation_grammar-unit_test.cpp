@@ -123,6 +123,9 @@ TEST_CASE("TranslationGrammar construction", "[TranslationGrammar]") {
                                      "x"_t.id() + 1,
                                      {{"X"_nt, {"X"_nt, "X"_nt}}, {"X"_nt, {"x"_t, "X"_nt}}},
                                      "X"_nt));
+  // identifiers of all symbols, including the augmented starting symbol, must fit in id_type
+  REQUIRE_THROWS_AS(TranslationGrammar(ctf::max_id, 1, {}, "X"_nt), std::invalid_argument);
+  REQUIRE_THROWS_AS(TranslationGrammar(1, ctf::max_id + 1, {}, "X"_nt), std::invalid_argument);
 }
 TEST_CASE("TranslationGrammar basic", "[TranslationGrammar]") {
   TranslationGrammar grammar{{
@@ -141,4 +144,35 @@ TEST_CASE("TranslationGrammar basic", "[TranslationGrammar]") {
 
   REQUIRE(grammar.terminals() == expectedTerminals);
   REQUIRE(grammar.nonterminals() == expectedNonterminals);
-}
\ No newline at end of file
+}
+
+TEST_CASE("PackedRules", "[TranslationGrammar]") {
+  TranslationGrammar grammar{{
+                               {"C"_nt,
+                                {"a"_t, "A"_nt, "B"_nt, "b"_t},
+                                {"A"_nt, "b"_t, "a"_t, "B"_nt, "y"_t},
+                                {{1, 4}, {}}},
+                               {"A"_nt, {}},
+                               {"B"_nt, {"x"_t}},
+                             },
+                             "C"_nt};
+  ctf::PackedRules rules(grammar);
+  REQUIRE(rules.size() == grammar.rules().size());
+
+  for (std::size_t i = 0; i < rules.size(); ++i) {
+    auto& rule = grammar.rules()[i];
+    auto& record = rules[i];
+    CHECK(record.nonterminal == rule.nonterminal());
+    CHECK(record.inputSize == rule.input().size());
+    CHECK(record.outputSize == rule.output().size());
+    CHECK(vector<Symbol>(rules.input(record).begin(), rules.input(record).end()) == rule.input());
+    CHECK(vector<Symbol>(rules.output(record).begin(), rules.output(record).end()) ==
+          rule.output());
+  }
+
+  // 2 input terminals; a: targets 4 and 1 at distances 0 and 3 from the last output symbol, b: none
+  auto plan = rules.plan(rules[0]);
+  CHECK(vector<ctf::id_type>(plan, plan + 5) == vector<ctf::id_type>{2, 2, 0, 3, 0});
+  // the empty rule has no input terminals
+  CHECK(*rules.plan(rules[1]) == 0);
+}
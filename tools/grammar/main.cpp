@@ -9,15 +9,11 @@
 
 using namespace ctfgc::literals;
 
-class TGLex : public LexicalAnalyzer {
+class TGLex : public LayoutLexicalAnalyzer {
  public:
-  using LexicalAnalyzer::LexicalAnalyzer;
+  TGLex() : LayoutLexicalAnalyzer("NEWLINE"_t, "INDENT"_t, "DEDENT"_t, Indentation::TABS) {}
 
-  Token read_token() override {
-    if (_buffered) {
-      --_buffered;
-      return _bufferedToken;
-    }
+  Token read_layout_token() override {
   read_new:
     int c = get();
     switch (c) {
@@ -57,10 +53,6 @@ class TGLex : public LexicalAnalyzer {
   }
 
  private:
-  unsigned char _tabs = 0;
-  unsigned char _buffered = 0;
-  Token _bufferedToken = Symbol::eof();
-
   Token token_terminal() {
     string s;
     for (int c = get(); c != '\''; c = get()) {
@@ -151,6 +143,7 @@ class TGLex : public LexicalAnalyzer {
   }
 
   Token token_integer(int c) {
+    // the value of every integer is used, so it is converted while reading
     std::size_t number = 0;
     do {
       number = number * 10 + c - '0';
@@ -161,30 +154,6 @@ class TGLex : public LexicalAnalyzer {
     return token("integer"_t, Attribute(number));
   }
 
-  Token token_newline() {
-    Token nl = token("NEWLINE"_t);
-    reset_location();
-    std::size_t tabs = 0;
-    int c;
-    while ((c = get()) == '\t') {
-      ++tabs;
-    }
-    unget();
-    if (c == ' ')
-      warning("Spaces are not allowed at the start of a new line.");
-    if (tabs < _tabs) {
-      _buffered = _tabs - tabs;
-      _tabs = tabs;
-      _bufferedToken = token("DEDENT"_t);
-    } else if (tabs > _tabs) {
-      _buffered = tabs - _tabs;
-      _tabs = tabs;
-      _bufferedToken = token("INDENT"_t);
-    }
-
-    return nl;
-  }
-
   Token comment() {
     int c;
     do {
@@ -198,11 +167,6 @@ class TGLex : public LexicalAnalyzer {
     }
     return token_eof();
   }
-
-  void reset_private() override {
-    _buffered = 0;
-    _tabs = 0;
-  }
 };
 
 // output generator:
@@ -212,7 +176,8 @@ class TGLex : public LexicalAnalyzer {
 
 class TGOutput : public OutputGenerator {
  public:
-  TGOutput(const std::string& outFolder) : OutputGenerator(), _outFolder(outFolder) {}
+  TGOutput(const std::string& outFolder, bool tables = false)
+    : OutputGenerator(), _outFolder(outFolder), _tables(tables) {}
 
   virtual void output(const tstack<Token>& out) override {
     // first pass: get all terminals and nonterminals and map them to size_t
@@ -230,6 +195,10 @@ class TGOutput : public OutputGenerator {
     generate_header(hs);
     // second pass: construct rules and functions, ensure that rules are in the correct form
     generate_rules(it, cpps);
+    // precompute the parsing table
+    if (_tables && !error()) {
+      generate_table(cpps);
+    }
     // output if there were no errors
     if (!error()) {
       std::ofstream hfs(_outFolder + "/" + _grammarName + ".h");
@@ -248,8 +217,24 @@ class TGOutput : public OutputGenerator {
   }
 
  private:
+  /**
+  \brief The description of a single rule for constructing the grammar in grammarc.
+  */
+  struct RuleData {
+    Symbol nonterminal;
+    vector<Symbol> input;
+    vector<Symbol> output;
+    vector<vector_set<std::size_t>> attributeActions;
+    bool differentOut;
+    bool customPrecedence;
+    Symbol precedenceSymbol;
+  };
+
   string _grammarName;
   string _outFolder;
+  bool _tables;
+  Symbol _startingSymbol = Symbol::eof();
+  vector<RuleData> _rules;
   std::set<string> _nonterminals;
   std::set<string> _terminals;
   std::set<string> _outTerminals;
@@ -265,6 +250,7 @@ class TGOutput : public OutputGenerator {
     _terminalMap.clear();
     _nonterminalMap.clear();
     _precedences.clear();
+    _rules.clear();
   }
 
   void build_precedence(tstack<Token>::const_iterator& it) {
@@ -378,6 +364,7 @@ class TGOutput : public OutputGenerator {
       fatal_error(it, "There must be at least one nonterminal in the grammar.");
     }
     string startingSymbol = it->attribute().get<string>();
+    _startingSymbol = Nonterminal(_nonterminalMap[startingSymbol]);
 
     while (*it != Symbol::eof()) {
       string nt = it->attribute().get<string>();
@@ -431,14 +418,17 @@ class TGOutput : public OutputGenerator {
       bool differentOut = false;
 
       string precedenceSymbol;
+      RuleData rule{Nonterminal(_nonterminalMap[nt]), {}, {}, {}, false, false, Symbol::eof()};
       os << "      {";
       while (*it != "string end"_t) {
         const string& id = it->attribute().get<string>();
         if (*it == "terminal"_t) {
           os << "\"" << id << "\"_t, ";
+          rule.input.push_back(Terminal(_terminalMap[id]));
           ++inputTerminals;
         } else if (*it == "nonterminal"_t) {
           os << "\"" << id << "\"_nt, ";
+          rule.input.push_back(Nonterminal(_nonterminalMap[id]));
           inputNonterminals.push_back(id);
         }
         ++it;
@@ -454,9 +444,11 @@ class TGOutput : public OutputGenerator {
           ++outputSymbols;
           if (*it == "terminal"_t) {
             os << "\"" << id << "\"_t, ";
+            rule.output.push_back(Terminal(_terminalMap[id]));
             outputTerminals.push_back(true);
           } else if (*it == "nonterminal"_t) {
             os << "\"" << id << "\"_nt, ";
+            rule.output.push_back(Nonterminal(_nonterminalMap[id]));
             outputNonterminals.push_back(id);
             outputTerminals.push_back(false);
           }
@@ -496,6 +488,7 @@ class TGOutput : public OutputGenerator {
           os << ",\n      ctf::vector<ctf::vector_set<std::size_t>>{";
           while (*it != "attribute list end"_t) {
             os << "{";
+            rule.attributeActions.emplace_back();
             while (*it != "attribute end"_t) {
               std::size_t target = it->attribute().get<std::size_t>() - 1;
               if (target >= outputTerminals.size() || !outputTerminals[target]) {
@@ -504,6 +497,7 @@ class TGOutput : public OutputGenerator {
                 error(it, errorMessage);
               }
               os << target << ", ";
+              rule.attributeActions.back().insert(target);
               ++it;
             }
             os << "}, ";
@@ -520,6 +514,7 @@ class TGOutput : public OutputGenerator {
           }
           while (printedAttributes < inputTerminals) {
             os << "{}, ";
+            rule.attributeActions.emplace_back();
             ++printedAttributes;
           }
           os << "}";
@@ -529,11 +524,64 @@ class TGOutput : public OutputGenerator {
         }
         ++it;
       }
+      rule.differentOut = differentOut;
+      rule.customPrecedence = customPrecedence;
+      if (customPrecedence) {
+        rule.precedenceSymbol = Terminal(_terminalMap[precedenceSymbol]);
+      }
+      _rules.push_back(std::move(rule));
     }
     os << "\n    ),\n",
       // move beyond rule end
       ++it;
   }
+  // construct the grammar in grammarc and output its saved parsing table
+  void generate_table(std::ostream& os) {
+    vector<Rule> rules;
+    for (auto& r : _rules) {
+      if (!r.differentOut) {
+        if (r.customPrecedence) {
+          rules.emplace_back(r.nonterminal, r.input, true, r.precedenceSymbol);
+        } else {
+          rules.emplace_back(r.nonterminal, r.input);
+        }
+      } else if (r.customPrecedence) {
+        rules.emplace_back(
+          r.nonterminal, r.input, r.output, r.attributeActions, true, r.precedenceSymbol);
+      } else {
+        rules.emplace_back(r.nonterminal, r.input, r.output, r.attributeActions);
+      }
+    }
+    vector<PrecedenceSet> precedences;
+    for (auto& [associativity, symbolVec] : _precedences) {
+      vector_set<Symbol> terminals;
+      for (auto& id : symbolVec) {
+        terminals.insert(Terminal(_terminalMap[id]));
+      }
+      precedences.push_back({associativity, std::move(terminals)});
+    }
+    TranslationGrammar grammar(std::move(rules), _startingSymbol, std::move(precedences));
+
+    LRAutoTable table;
+    try {
+      table = LRAutoTable(grammar);
+    } catch (std::invalid_argument& e) {
+      error(e.what());
+      throw CodeGenerationException("Could not construct the parsing table.");
+    }
+    if (table.unresolved_conflicts() != 0) {
+      warning(std::to_string(table.unresolved_conflicts()) +
+              " R/R conflicts resolved by selecting the rule defined first.");
+    }
+    // report the selected algorithm
+    this->os() << _grammarName << ": " << to_string(table.algorithm()) << " table, "
+               << table.states() << " states, " << table.size() << " entries\n";
+
+    os << "const char* " << _grammarName << "::table = R\"(";
+    table.save(os);
+    os << ")\";\n";
+  }
+
   // generate header with declarations and name mapping functions
   void generate_header(std::ostream& os) {
     // include ctf
@@ -587,6 +635,9 @@ class TGOutput : public OutputGenerator {
           "  return s.to_string();\n"
           "}\n\n"
           "extern ctf::TranslationGrammar grammar;\n\n";
+    if (_tables) {
+      os << "extern const char* table;\n\n";
+    }
 
     os << "}\n#endif\n";
   }
@@ -595,13 +646,16 @@ class TGOutput : public OutputGenerator {
 // TODO file or stdin input
 // todo which arguments
 
-// ./ctfgc [-i] [input/stdin] [-o] [output folder/.]
+// ./ctfgc [-i] [input/stdin] [-o] [output folder/.] [-t]
 int main(int argc, char** argv) try {
   TCLAP::CmdLine cmd("ctfgc: translate translation grammar .ctfg files to C++", ' ', "1.0");
   TCLAP::UnlabeledValueArg<std::string> inputArg("input", "input file", true, "", "input file");
   TCLAP::ValueArg<std::string> outputArg("o", "output", "output folder", false, ".", "output file");
+  TCLAP::SwitchArg tablesArg(
+    "t", "tables", "precompute the parsing table, selecting the LR algorithm automatically");
   cmd.add(inputArg);
   cmd.add(outputArg);
+  cmd.add(tablesArg);
   cmd.parse(argc, argv);
   std::string outputFolder = outputArg.getValue();
   std::string input = inputArg.getValue();
@@ -620,7 +674,8 @@ int main(int argc, char** argv) try {
     i = &file;
   }
   // run translation
-  Translation t(TGLex(), ctfgc::grammar, TGOutput(outputFolder), ctfgc::to_string);
+  Translation t(
+    TGLex(), ctfgc::grammar, TGOutput(outputFolder, tablesArg.getValue()), ctfgc::to_string);
   auto result = t.run(*i, std::cout, std::cerr, input);
   switch (result) {
     case TranslationResult::SUCCESS: